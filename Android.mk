@@ -82,6 +82,7 @@ LOCAL_SRC_FILES := \
     stream/src/Stream.cpp \
     stream/src/StreamCompress.cpp \
     stream/src/StreamPCM.cpp \
+    stream/src/StreamIoGate.cpp \
     stream/src/StreamACDB.cpp \
     stream/src/StreamInCall.cpp \
     stream/src/StreamNonTunnel.cpp \
@@ -106,13 +107,16 @@ LOCAL_SRC_FILES := \
     device/src/HeadsetVaMic.cpp \
     device/src/RTProxy.cpp \
     device/src/SpeakerProtection.cpp \
+    device/src/SpkrCalWindow.cpp \
     device/src/FMDevice.cpp \
     device/src/ExtEC.cpp \
     device/src/HapticsDev.cpp \
     device/src/UltrasoundDevice.cpp \
     device/src/ECRefDevice.cpp \
     session/src/Session.cpp \
+    session/src/TimestampExtrapolator.cpp \
     session/src/PayloadBuilder.cpp \
+    session/src/UsecaseKvIndex.cpp \
     session/src/SessionAlsaPcm.cpp \
     session/src/SessionAgm.cpp \
     session/src/SessionAlsaUtils.cpp \
@@ -126,10 +130,12 @@ LOCAL_SRC_FILES := \
     session/src/ACDEngine.cpp \
     resource_manager/src/ResourceManager.cpp \
     resource_manager/src/SndCardMonitor.cpp \
+    resource_manager/src/FrontEndPool.cpp \
     utils/src/SoundTriggerPlatformInfo.cpp \
     utils/src/ACDPlatformInfo.cpp \
     utils/src/VoiceUIPlatformInfo.cpp \
     utils/src/PalRingBuffer.cpp \
+    utils/src/PalExecutor.cpp \
     utils/src/SoundTriggerUtils.cpp \
     utils/src/VoiceUIInterface.cpp \
     utils/src/SVAInterface.cpp \
@@ -220,6 +226,148 @@ include $(BUILD_EXECUTABLE)
 
 include $(CLEAR_VARS)
 
+LOCAL_MODULE               := PalHostUnitTests
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/TimestampExtrapolatorTest.cpp \
+                    session/src/TimestampExtrapolator.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/session/inc
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalSpkrCalWindowTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/SpkrCalWindowTest.cpp \
+                    device/src/SpkrCalWindow.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/device/inc
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalStreamIoGateTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/StreamIoGateTest.cpp \
+                    stream/src/StreamIoGate.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/stream/inc
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalRingBufferTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/PalRingBufferTest.cpp \
+                    utils/src/PalRingBuffer.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/test/unit/host \
+                    $(LOCAL_PATH) \
+                    $(LOCAL_PATH)/utils/inc
+
+LOCAL_HEADER_LIBRARIES := liblog_headers
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalRingBufferBenchmark
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/PalRingBufferBenchmark.cpp \
+                    utils/src/PalRingBuffer.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/test/unit/host \
+                    $(LOCAL_PATH) \
+                    $(LOCAL_PATH)/utils/inc
+
+LOCAL_HEADER_LIBRARIES := liblog_headers
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalFrontEndPoolTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/FrontEndPoolTest.cpp \
+                    resource_manager/src/FrontEndPool.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/test/unit/host \
+                    $(LOCAL_PATH) \
+                    $(LOCAL_PATH)/resource_manager/inc
+
+LOCAL_HEADER_LIBRARIES := liblog_headers
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalLabReadLatencyTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/LabReadLatencyTest.cpp \
+                    utils/src/PalRingBuffer.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/test/unit/host \
+                    $(LOCAL_PATH) \
+                    $(LOCAL_PATH)/utils/inc
+
+LOCAL_HEADER_LIBRARIES := liblog_headers
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE               := PalUsecaseKvIndexBenchmark
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_CFLAGS += -Wall -Werror -UNDEBUG
+
+LOCAL_SRC_FILES  := test/unit/UsecaseKvIndexBenchmark.cpp \
+                    session/src/UsecaseKvIndex.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/session/inc
+
+LOCAL_STATIC_LIBRARIES := libexpat
+
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
 include $(PAL_BASE_PATH)/plugins/Android.mk
 include $(PAL_BASE_PATH)/ipc/HwBinders/Android.mk
 
@@ -104,6 +104,19 @@ static void notify_concurrent_stream(pal_stream_type_t type,
     rm->ConcurrentStreamStatus(type, dir, active);
 }
 
+/*
+ * Resolve a handle returned by pal_stream_open to its stream, lock free.
+ * Returns NULL for unknown handles and handles of closed streams.
+ */
+static Stream* getStreamFromHandle(pal_stream_handle_t *stream_handle)
+{
+    std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+
+    if (!rm)
+        return NULL;
+    return rm->getStreamFromHandle(stream_handle);
+}
+
 /*
  * pal_init - Initialize PAL
  *
@@ -254,8 +267,17 @@ int32_t pal_stream_open(struct pal_stream_attributes *attributes,
     if (cb)
        s->registerCallBack(cb, cookie);
 
+    stream = rm->allocStreamHandle(s);
+    if (!stream) {
+        status = -ENOMEM;
+        if (s->close() != 0) {
+            PAL_ERR(LOG_TAG, "stream closed failed.");
+        }
+        notify_concurrent_stream(sAttr.type, sAttr.direction, false);
+        delete s;
+        goto exit;
+    }
     rm->initStreamUserCounter(s);
-    stream = reinterpret_cast<uint64_t *>(s);
     *stream_handle = stream;
 exit:
     PAL_INFO(LOG_TAG, "Exit. Value of stream_handle %pK, status %d", stream, status);
@@ -283,7 +305,8 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
     }
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         status = -EINVAL;
         rm->unlockActiveStream();
         return status;
@@ -291,7 +314,6 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
 
     rm->unlockActiveStream();
 
-    s = reinterpret_cast<Stream *>(stream_handle);
     s->setCachedState(STREAM_IDLE);
     status = s->close();
 
@@ -341,12 +363,12 @@ int32_t pal_stream_start(pal_stream_handle_t *stream_handle)
     }
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         goto exit;
     }
-    s = reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -395,13 +417,13 @@ int32_t pal_stream_stop(pal_stream_handle_t *stream_handle)
     }
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         goto exit;
     }
 
-    s = reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -436,7 +458,12 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
         return status;
     }
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->write(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream write failed status %d", status);
@@ -456,7 +483,12 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
         return status;
     }
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->read(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream read failed status %d", status);
@@ -479,7 +511,12 @@ int32_t pal_stream_get_param(pal_stream_handle_t *stream_handle,
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->getParameters(param_id, (void **)param_payload);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "get parameters failed status %d param_id %u", status, param_id);
@@ -503,7 +540,12 @@ int32_t pal_stream_set_param(pal_stream_handle_t *stream_handle, uint32_t param_
     }
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK param_id %d", stream_handle,
             param_id);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     if (PAL_PARAM_ID_UIEFFECT == param_id) {
         status = s->setEffectParameters((void *)param_payload);
     } else {
@@ -549,13 +591,13 @@ int32_t pal_stream_set_volume(pal_stream_handle_t *stream_handle,
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         return status;
     }
 
-    s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -602,13 +644,13 @@ int32_t pal_stream_set_mute(pal_stream_handle_t *stream_handle, bool state)
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         goto exit;
     }
 
-    s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -644,7 +686,12 @@ int32_t pal_stream_pause(pal_stream_handle_t *stream_handle)
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->pause();
     if (0 != status) {
         PAL_ERR(LOG_TAG, "pal_stream_pause failed with status %d", status);
@@ -666,7 +713,12 @@ int32_t pal_stream_resume(pal_stream_handle_t *stream_handle)
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
 
     status = s->resume();
     if (0 != status) {
@@ -702,13 +754,13 @@ int32_t pal_stream_drain(pal_stream_handle_t *stream_handle, pal_drain_type_t ty
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         goto exit;
     }
 
-    s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -744,7 +796,12 @@ int32_t pal_stream_flush(pal_stream_handle_t *stream_handle)
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
 
     status = s->flush();
     if (0 != status) {
@@ -768,7 +825,12 @@ int32_t pal_stream_suspend(pal_stream_handle_t *stream_handle)
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
 
     status = s->suspend();
     if (0 != status) {
@@ -793,7 +855,12 @@ int32_t pal_stream_set_buffer_size (pal_stream_handle_t *stream_handle,
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
 
     status = s->setBufInfo(in_buffer_cfg, out_buffer_cfg);
     if (0 != status) {
@@ -826,8 +893,8 @@ int32_t pal_get_timestamp(pal_stream_handle_t *stream_handle,
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK\n", stream_handle);
 
     rm->lockActiveStream();
-    if (rm->isActiveStream(stream_handle)) {
-        s =  reinterpret_cast<Stream *>(stream_handle);
+    s = rm->getStreamFromHandle(stream_handle);
+    if (s) {
         status = s->getTimestamp(stime);
     } else {
         PAL_ERR(LOG_TAG, "stream handle in stale state.\n");
@@ -860,7 +927,12 @@ int32_t pal_add_remove_effect(pal_stream_handle_t *stream_handle,
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->addRemoveEffect(effect, enable);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "pal_add_effect failed with status %d", status);
@@ -907,7 +979,8 @@ int32_t pal_stream_set_device(pal_stream_handle_t *stream_handle,
     PAL_INFO(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
     rm->lockActiveStream();
-    if (!rm->isActiveStream(stream_handle)) {
+    s = rm->getStreamFromHandle(stream_handle);
+    if (!s) {
         rm->unlockActiveStream();
         status = -EINVAL;
         return status;
@@ -915,7 +988,6 @@ int32_t pal_stream_set_device(pal_stream_handle_t *stream_handle,
 
     /* Choose best device config for this stream */
     /* TODO: Decide whether to update device config or not based on flag */
-    s = reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
         rm->unlockActiveStream();
@@ -1069,7 +1141,12 @@ int32_t pal_stream_get_tags_with_module_info(pal_stream_handle_t *stream_handle,
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->getTagsWithModuleInfo(size, payload);
 
     PAL_DBG(LOG_TAG, "Exit. Stream handle: %pK, status %d", stream_handle, status);
@@ -1135,7 +1212,12 @@ int32_t pal_stream_get_mmap_position(pal_stream_handle_t *stream_handle,
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->GetMmapPosition(position);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "pal_stream_get_mmap_position failed with status %d", status);
@@ -1159,7 +1241,12 @@ int32_t pal_stream_create_mmap_buffer(pal_stream_handle_t *stream_handle,
     }
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
-    s =  reinterpret_cast<Stream *>(stream_handle);
+    s = getStreamFromHandle(stream_handle);
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle %pK status %d", stream_handle, status);
+        return status;
+    }
     status = s->createMmapBuffer(min_size_frames, info);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "pal_stream_create_mmap_buffer failed with status %d", status);
@@ -35,6 +35,7 @@
 #include <bt_intf.h>
 #include <bt_ble.h>
 #include <vector>
+#include <map>
 #include <mutex>
 #include <system/audio.h>
 
@@ -144,6 +145,12 @@ protected:
     std::mutex                 mAbrMutex;
     int                        totalActiveSessionRequests;
 
+    /* codec libraries stay loaded once opened, keyed by library path */
+    static std::map<std::string, std::pair<void *, open_fn_t>> pluginLibCache;
+    static std::mutex pluginLibCacheMutex;
+
+    int getPluginOpenFn(const std::string &libPath, void **handle,
+                        open_fn_t *openFn);
     int getPluginPayload(void **handle, bt_codec_t **btCodec,
                          bt_enc_payload_t **out_buf,
                          codec_type codecType);
@@ -68,10 +68,12 @@
 #include "sp_vi.h"
 #include "sp_rx.h"
 #include "cps_data_router.h"
+#include "SpkrCalWindow.h"
 #include <tinyalsa/asoundlib.h>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
 #include<vector>
 #include "apm_api.h"
 
@@ -86,6 +88,9 @@ class Device;
 #define WSA2_REGISTER_ADD 1
 #define WSA_REGISTER_ADD 0
 
+#define SPKR_TELEMETRY_RING_SIZE 16
+#define SPKR_XMAX_TMAX_LOG_INTERVAL_MS 1000
+
 typedef enum speaker_prot_cal_state {
     SPKR_NOT_CALIBRATED,     /* Speaker not calibrated  */
     SPKR_CALIBRATED,         /* Speaker calibrated  */
@@ -112,6 +117,12 @@ enum {
     SPKR_CLOSE = 3,
 };
 
+/* seqlock slot: odd seq means the sampler is writing it */
+struct spkr_telemetry_slot {
+    std::atomic<uint32_t> seq;
+    pal_sp_telemetry_sample_t sample;
+};
+
 struct agmMetaData {
     uint8_t *buf;
     uint32_t size;
@@ -130,11 +141,11 @@ protected :
     static speaker_prot_cal_state spkrCalState;
     spkr_prot_proc_state spkrProcessingState;
     int *spkerTempList;
-    static bool isSpkrInUse;
     static bool startXmaxLogging;
     static bool calThrdCreated;
     static bool isDynamicCalTriggered;
-    static struct timespec spkrLastTimeUsed;
+    /* usage state, guarded by spkrUsageMutex */
+    static SpkrCalWindow spkrCalWindow;
     static struct mixer *virtMixer;
     static struct mixer *hwMixer;
     static struct pcm *rxPcm;
@@ -154,6 +165,18 @@ protected :
     static int numberOfRequest;
     static struct pal_device_info vi_device;
     static struct pal_device_info cps_device;
+    static std::vector<struct mixer_ctl *> spkrTempCtls;
+    static std::mutex spkrTempCtlsMutex;
+    static struct mixer_ctl *xmaxTmaxCtl;
+    static uint32_t xmaxTmaxMiid;
+    static std::mutex telemetryMutex;
+    static std::condition_variable telemetryCv;
+    static struct spkr_telemetry_slot telemetryRing[SPKR_TELEMETRY_RING_SIZE];
+    static std::atomic<uint32_t> telemetryHead;
+    static void publishTelemetry(const pal_sp_telemetry_sample_t *sample);
+    int32_t resolveSpkrXmaxTmaxCtl();
+    void startXmaxTmaxTelemetry();
+    void stopXmaxTmaxTelemetry();
 
 private :
 
@@ -164,7 +187,10 @@ public:
     static std::mutex cvMutex;
     std::mutex deviceMutex;
     static std::mutex calibrationMutex;
+    static std::mutex spkrUsageMutex;
+    static std::condition_variable spkrUsageCv;
     void spkrCalibrationThread();
+    void spkrWaitForCalWindow();
     void startSpkrXmaxTmaxLogging();
     int getSpeakerTemperature(int spkr_pos);
     void spkrCalibrateWait();
@@ -198,6 +224,8 @@ public:
     int32_t getCalibrationData(void **param);
     int32_t getFTMParameter(void **param);
     int32_t getSpkrXmaxTmaxData();
+    static int getSpkrTelemetry(pal_sp_telemetry_sample_t *samples, int count);
+    int32_t getTelemetryParameter(void **param);
     void disconnectFeandBe(std::vector<int> pcmDevIds, std::string backEndName);
 };
 
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef SPKR_CAL_WINDOW_H
+#define SPKR_CAL_WINDOW_H
+
+#include <stdint.h>
+
+/* remaining(): calibration has to wait for the speaker to stop */
+#define SPKR_CAL_WAIT_STOP -1
+
+/* Seconds clock the calibration window is measured with */
+class SpkrCalClock {
+public:
+    virtual ~SpkrCalClock() {};
+    virtual int64_t nowSec() = 0;
+};
+
+/* CLOCK_BOOTTIME, so the idle time keeps counting across suspend */
+class SpkrBootClock : public SpkrCalClock {
+public:
+    int64_t nowSec() override;
+};
+
+/*
+ * Speaker usage state and the decision when speaker calibration may run:
+ * the speaker must be out of use for minIdleSec, unless a dynamic
+ * calibration was requested. Time is read only through the clock, so the
+ * decision can be unit tested on the host with a fake one.
+ */
+class SpkrCalWindow {
+public:
+    SpkrCalWindow(SpkrCalClock *clock = nullptr);
+    void setInUse(bool inUse);
+    void restartIdle();
+    bool inUse() const { return inUse_; }
+    int64_t lastUsedSec() const { return lastUsedSec_; }
+    int64_t idleSec();
+    int64_t remaining(int64_t minIdleSec, bool dynamicCal);
+
+private:
+    SpkrCalClock *clock_;
+    bool inUse_;
+    int64_t lastUsedSec_;
+};
+
+#endif // SPKR_CAL_WINDOW_H
@@ -72,6 +72,9 @@
 #include <vector>
 #include <system/audio.h>
 #include <map>
+#include <string>
+#include <mutex>
+#include <condition_variable>
 
 #define USB_BUFF_SIZE           4096
 #define CHANNEL_NUMBER_STR      "Channels: "
@@ -90,12 +93,35 @@
 #define DEFAULT_SERVICE_INTERVAL_US    0
 #define USB_IN_JACK_SUFFIX "Input Jack"
 #define USB_OUT_JACK_SUFFIX "Output Jack"
+#define USB_JACK_PROBE_TIMEOUT_MS 1000
+#ifndef USB_CAPS_CACHE_FILE
+#define USB_CAPS_CACHE_FILE "/data/vendor/audio/usb_caps_cache.txt"
+#endif
+#define USB_CAPS_CACHE_VERSION 2
+#define USB_CAPS_CACHE_MAX_ENTRIES 16
 
 typedef enum usb_usecase_type{
     USB_CAPTURE = 0,
     USB_PLAYBACK,
 } usb_usecase_type_t;
 
+struct usb_altset_caps {
+    usb_usecase_type_t type;
+    unsigned int bit_width;
+    unsigned int channels;
+    unsigned long interval;
+    std::vector<unsigned int> rates;
+};
+
+/* parsed stream0 section of one direction, keyed by "vid:pid:dir" */
+struct usb_caps_cache_entry {
+    uint32_t desc_hash;
+    int endian;
+    std::vector<usb_altset_caps> altsets;
+    /* caps_cache_clock_ at the last save or restore, for LRU eviction */
+    uint64_t last_used;
+};
+
 // one card supports multiple devices
 class USBDeviceConfig {
 protected:
@@ -117,6 +143,8 @@ public:
     unsigned long getInterval();
     unsigned int getDefaultRate();
     int getSampleRates(int type, char *rates_str);
+    void setSampleRates(usb_usecase_type_t type, const std::vector<unsigned int> &rates);
+    const std::vector<unsigned int>& getSampleRates() {return rates_;};
     bool isRateSupported(int requested_rate);
     int getBestRate(int requested_rate, int candidate_rate, unsigned int *best_rate);
     void usb_find_sample_rate_candidate(int base, int requested_rate,
@@ -130,13 +158,29 @@ public:
     unsigned int getSRMask(usb_usecase_type_t type) {return supported_sample_rates_mask_[type];} ;
 };
 
-class USBCardConfig {
+class USBCardConfig : public std::enable_shared_from_this<USBCardConfig> {
 protected:
     struct pal_usb_device_address address_;
     int endian_;
     std::multimap<uint32_t, std::shared_ptr<USBDeviceConfig>> format_list_map;
     std::vector <std::shared_ptr<USBDeviceConfig>> usb_device_config_list_;
     unsigned int usb_supported_sample_rates_mask_[2] = {0};
+    /* jack state is probed off the connection path, see probeJackStatus() */
+    std::mutex jack_mutex_;
+    std::condition_variable jack_cond_;
+    bool jack_probe_pending_ = false;
+    /* capabilities of previously seen devices, persisted in USB_CAPS_CACHE_FILE */
+    static std::map<std::string, usb_caps_cache_entry> caps_cache_;
+    static std::mutex caps_cache_mutex_;
+    static std::mutex caps_cache_file_mutex_;
+    static bool caps_cache_loaded_;
+    static uint64_t caps_cache_clock_;
+    static void loadCapsCache();
+    static void storeCapsCache();
+    static uint32_t getDescriptorHash(const char *read_buf);
+    static int readUsbId(int card, std::string &usbid);
+    bool restoreCapability(usb_usecase_type_t type, const std::string &key, uint32_t hash);
+    void saveCapability(usb_usecase_type_t type, const std::string &key, uint32_t hash);
     void usb_info_dump(char* read_buf, int type);
 public:
     USBCardConfig(struct pal_usb_device_address address);
@@ -160,6 +204,8 @@ public:
     static const unsigned int in_chn_mask_[MAX_SUPPORTED_CHANNEL_MASKS];
     bool isCaptureProfileSupported();
     bool readDefaultJackStatus(bool is_playback);
+    void startJackStatusProbe(usb_usecase_type_t type);
+    void probeJackStatus(usb_usecase_type_t type);
     bool getJackConnectionStatus (int usb_card, const char* suffix);
 };
 
@@ -135,6 +135,49 @@ bool Bluetooth::isPlaceholderEncoder()
     }
 }
 
+std::map<std::string, std::pair<void *, open_fn_t>> Bluetooth::pluginLibCache;
+std::mutex Bluetooth::pluginLibCacheMutex;
+
+/*
+ * Resolve plugin_open for a codec library, loading it on first use. The
+ * handle is kept for the life of the process so routing back to BT does
+ * not pay dlopen/relocation again; callers must not dlclose it.
+ */
+int Bluetooth::getPluginOpenFn(const std::string &libPath, void **handle,
+                               open_fn_t *openFn)
+{
+    std::lock_guard<std::mutex> lock(pluginLibCacheMutex);
+    auto it = pluginLibCache.find(libPath);
+    void *libHandle = NULL;
+    open_fn_t plugin_open_fn = NULL;
+
+    if (it != pluginLibCache.end()) {
+        *handle = it->second.first;
+        *openFn = it->second.second;
+        return 0;
+    }
+
+    libHandle = dlopen(libPath.c_str(), RTLD_NOW);
+    if (libHandle == NULL) {
+        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", libPath.c_str());
+        return -EINVAL;
+    }
+
+    dlerror();
+    plugin_open_fn = (open_fn_t)dlsym(libHandle, "plugin_open");
+    if (!plugin_open_fn) {
+        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
+        dlclose(libHandle);
+        return -EINVAL;
+    }
+
+    PAL_INFO(LOG_TAG, "loaded BT codec lib %s", libPath.c_str());
+    pluginLibCache[libPath] = std::make_pair(libHandle, plugin_open_fn);
+    *handle = libHandle;
+    *openFn = plugin_open_fn;
+    return 0;
+}
+
 int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
               bt_enc_payload_t **out_buf, codec_type codecType)
 {
@@ -150,19 +193,9 @@ int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
         return -ENOSYS;
     }
 
-    handle = dlopen(lib_path.c_str(), RTLD_NOW);
-    if (handle == NULL) {
-        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", lib_path.c_str());
-        return -EINVAL;
-    }
-
-    dlerror();
-    plugin_open_fn = (open_fn_t)dlsym(handle, "plugin_open");
-    if (!plugin_open_fn) {
-        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
-        status = -EINVAL;
-        goto error;
-    }
+    status = getPluginOpenFn(lib_path, &handle, &plugin_open_fn);
+    if (status)
+        return status;
 
     status = plugin_open_fn(&codec, codecFormat, codecType);
     if (status) {
@@ -182,9 +215,6 @@ int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
 error:
     if (codec)
         codec->close_plugin(codec);
-
-    if (handle)
-        dlclose(handle);
 done:
     return status;
 }
@@ -835,7 +865,6 @@ void Bluetooth::startAbr()
                   (uint32_t *)blk->payload, blk->payload_sz, miid, blk->param_id);
 
         codec->close_plugin(codec);
-        dlclose(pluginLibHandle);
 
         if (!paramData) {
             PAL_ERR(LOG_TAG, "Failed to populateAPMHeader");
@@ -973,7 +1002,6 @@ void Bluetooth::startAbr()
             }
 
             codec->close_plugin(codec);
-            dlclose(pluginLibHandle);
 
             if (fbDevice.id == PAL_DEVICE_IN_BLUETOOTH_SCO_HEADSET) {
                 /* COP v2 DEPACKETIZER Module Configuration */
@@ -1874,10 +1902,7 @@ int BtA2dp::stopPlayback()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
+        pluginHandler = NULL;
     }
 
     PAL_DBG(LOG_TAG, "Stop A2DP playback, total active sessions :%d",
@@ -2064,10 +2089,7 @@ int BtA2dp::stopCapture()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
+        pluginHandler = NULL;
     }
     PAL_DBG(LOG_TAG, "Stop A2DP capture, total active sessions :%d",
             totalActiveSessionRequests);
@@ -2671,10 +2693,7 @@ int BtSco::stop()
         pluginCodec->close_plugin(pluginCodec);
         pluginCodec = NULL;
     }
-    if (pluginHandler) {
-        dlclose(pluginHandler);
-        pluginHandler = NULL;
-    }
+    pluginHandler = NULL;
 
     Device::stop_l();
     if (isAbrEnabled == false)
@@ -39,6 +39,8 @@
 #include "PayloadBuilder.h"
 #include "Device.h"
 #include "kvh2xml.h"
+#include "PalExecutor.h"
+#include <condition_variable>
 
 enum {
     EXT_DISPLAY_TYPE_NONE,
@@ -59,12 +61,31 @@ enum {
 #define CONNECT         "Connect"
 #define DISCONNECT      "Disconnect"
 
+#define EDID_CACHE_TIMEOUT_MS 500
+
 static struct extDispState {
     void *edidInfo = NULL;
     bool valid = false;
+    /* EDID read queued on the executor, not yet published */
+    bool pending = false;
+    /* bumped by every cacheEdid() and resetEdidInfo(), see cacheEdid() */
+    uint32_t generation = 0;
     int type = EXT_DISPLAY_TYPE_NONE;
 } extDisp[MAX_CONTROLLERS][MAX_STREAMS_PER_CONTROLLER];
 
+/* serializes EDID parsing against readers of extDisp[][].edidInfo */
+static std::mutex edidMutex;
+static std::condition_variable edidCond;
+
+static void waitForEdid(int controller, int stream)
+{
+    std::unique_lock<std::mutex> lock(edidMutex);
+
+    if (!edidCond.wait_for(lock, std::chrono::milliseconds(EDID_CACHE_TIMEOUT_MS),
+                           [&] { return !extDisp[controller][stream].pending; }))
+        PAL_ERR(LOG_TAG, "EDID for %d/%d not ready", controller, stream);
+}
+
 std::shared_ptr<Device> DisplayPort::dpObjRx = nullptr;
 std::shared_ptr<Device> DisplayPort::hdmiObjRx = nullptr;
 std::shared_ptr<Device> DisplayPort::objTx = nullptr;
@@ -473,6 +494,7 @@ bool DisplayPort::isDisplayPortEnabled () {
 
 void DisplayPort::resetEdidInfo() {
     PAL_VERBOSE(LOG_TAG," enter");
+    std::lock_guard<std::mutex> lock(edidMutex);
 
     int i = 0, j = 0;
     for (i = 0; i < MAX_CONTROLLERS; ++i) {
@@ -484,8 +506,11 @@ void DisplayPort::resetEdidInfo() {
                 state->edidInfo = NULL;
             }
             state->valid = false;
+            state->pending = false;
+            state->generation++;
         }
     }
+    edidCond.notify_all();
 }
 
 /*
@@ -700,9 +725,39 @@ fail:
     return -EINVAL;
 }
 
+/*
+ * Parse the EDID off the connection path; the connect handler holds the
+ * RM lock and the sink caps are only needed once a stream opens, where
+ * waitForEdid() picks up the published result. A task that runs after a
+ * resetEdidInfo() or a newer cacheEdid() for the same display finds the
+ * generation moved on and drops its read, so a disconnected sink's EDID
+ * never lands in the cache.
+ */
 void DisplayPort::cacheEdid(struct audio_mixer *mixer, int controller, int stream)
 {
-    getEdidInfo(mixer, controller, stream);
+    uint32_t generation = 0;
+
+    if (-EINVAL == getDisplayPortCtlIndex(controller, stream)) {
+        PAL_ERR(LOG_TAG," Unknown controller/stream %d/%d", controller, stream);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(edidMutex);
+        extDisp[controller][stream].pending = true;
+        generation = ++extDisp[controller][stream].generation;
+    }
+    PalExecutor::getInstance()->post([mixer, controller, stream, generation] {
+        std::lock_guard<std::mutex> lock(edidMutex);
+
+        if (extDisp[controller][stream].generation != generation) {
+            PAL_DBG(LOG_TAG, "stale EDID read for %d/%d dropped", controller, stream);
+            return;
+        }
+        getEdidInfo(mixer, controller, stream);
+        extDisp[controller][stream].pending = false;
+        edidCond.notify_all();
+    });
 }
 
 int32_t DisplayPort::isSampleRateSupported(uint32_t sampleRate)
@@ -1708,6 +1763,7 @@ bool DisplayPort::isSupportedSR(edidAudioInfo* info, int sr)
     int i = 0;
     struct extDispState *state = NULL;
 
+    waitForEdid(dp_controller, dp_stream);
     state = &extDisp[dp_controller][dp_stream];
     if (state && state->edidInfo)
     {
@@ -1733,6 +1789,7 @@ int DisplayPort::getMaxChannel()
     int max_channel = 2;
     edidAudioInfo *info = NULL;
 
+    waitForEdid(dp_controller, dp_stream);
     state = &extDisp[dp_controller][dp_stream];
     if (state && state->edidInfo)
     {
@@ -1782,6 +1839,7 @@ int DisplayPort::getHighestSupportedSR()
     struct extDispState *state = NULL;
     edidAudioInfo *info = NULL;
 
+    waitForEdid(dp_controller, dp_stream);
     state = &extDisp[dp_controller][dp_stream];
     if (state && state->edidInfo)
     {
@@ -1817,6 +1875,7 @@ int DisplayPort::getHighestSupportedBps()
     struct extDispState *state = NULL;
     edidAudioInfo *info = NULL;
 
+    waitForEdid(dp_controller, dp_stream);
     state = &extDisp[dp_controller][dp_stream];
     if (state && state->edidInfo)
     {
@@ -67,6 +67,8 @@
 #include "SessionAlsaUtils.h"
 #include "kvh2xml.h"
 #include <errno.h>
+#include <unistd.h>
+#include <algorithm>
 #include <agm/agm_api.h>
 
 #include<fstream>
@@ -127,12 +129,13 @@ std::thread SpeakerProtection::XmaxTmaxLogThread;
 std::condition_variable SpeakerProtection::cv;
 std::mutex SpeakerProtection::cvMutex;
 std::mutex SpeakerProtection::calibrationMutex;
+std::mutex SpeakerProtection::spkrUsageMutex;
+std::condition_variable SpeakerProtection::spkrUsageCv;
 
-bool SpeakerProtection::isSpkrInUse;
 bool SpeakerProtection::calThrdCreated;
 bool SpeakerProtection::isDynamicCalTriggered = false;
 bool SpeakerProtection::startXmaxLogging = false;
-struct timespec SpeakerProtection::spkrLastTimeUsed;
+SpkrCalWindow SpeakerProtection::spkrCalWindow;
 struct mixer *SpeakerProtection::virtMixer;
 struct mixer *SpeakerProtection::hwMixer;
 speaker_prot_cal_state SpeakerProtection::spkrCalState;
@@ -151,6 +154,14 @@ struct pal_device_info SpeakerProtection::cps_device;
 int SpeakerProtection::calibrationCallbackStatus;
 int SpeakerProtection::numberOfRequest;
 bool SpeakerProtection::mDspCallbackRcvd;
+std::vector<struct mixer_ctl *> SpeakerProtection::spkrTempCtls;
+std::mutex SpeakerProtection::spkrTempCtlsMutex;
+struct mixer_ctl *SpeakerProtection::xmaxTmaxCtl = NULL;
+uint32_t SpeakerProtection::xmaxTmaxMiid = 0;
+std::mutex SpeakerProtection::telemetryMutex;
+std::condition_variable SpeakerProtection::telemetryCv;
+struct spkr_telemetry_slot SpeakerProtection::telemetryRing[SPKR_TELEMETRY_RING_SIZE];
+std::atomic<uint32_t> SpeakerProtection::telemetryHead(0);
 std::shared_ptr<Device> SpeakerFeedback::obj = nullptr;
 int SpeakerFeedback::numSpeaker;
 
@@ -202,7 +213,6 @@ cps_reg_wr_values_t sp_cps_thrsh_values = {
  */
 bool SpeakerProtection::isSpeakerInUse(unsigned long *sec)
 {
-    struct timespec temp;
     PAL_DBG(LOG_TAG, "Enter");
 
     if (!sec) {
@@ -210,14 +220,14 @@ bool SpeakerProtection::isSpeakerInUse(unsigned long *sec)
         return false;
     }
 
-    if (isSpkrInUse) {
+    std::lock_guard<std::mutex> lock(spkrUsageMutex);
+    if (spkrCalWindow.inUse()) {
         PAL_INFO(LOG_TAG, "Speaker in use");
         *sec = 0;
         return true;
     } else {
         PAL_INFO(LOG_TAG, "Speaker not in use");
-        clock_gettime(CLOCK_BOOTTIME, &temp);
-        *sec = temp.tv_sec - spkrLastTimeUsed.tv_sec;
+        *sec = spkrCalWindow.idleSec();
     }
 
     PAL_DBG(LOG_TAG, "Idle time %ld", *sec);
@@ -230,17 +240,43 @@ void SpeakerProtection::spkrProtSetSpkrStatus(bool enable)
 {
     PAL_DBG(LOG_TAG, "Enter");
 
-    if (enable)
-        isSpkrInUse = true;
-    else {
-        isSpkrInUse = false;
-        clock_gettime(CLOCK_BOOTTIME, &spkrLastTimeUsed);
-        PAL_INFO(LOG_TAG, "Speaker used last time %ld", spkrLastTimeUsed.tv_sec);
+    {
+        std::lock_guard<std::mutex> lock(spkrUsageMutex);
+        spkrCalWindow.setInUse(enable);
+        if (!enable)
+            PAL_INFO(LOG_TAG, "Speaker used last time %lld",
+                     (long long)spkrCalWindow.lastUsedSec());
     }
+    /* usage transition: re-arm the calibration deadline */
+    spkrUsageCv.notify_all();
 
     PAL_DBG(LOG_TAG, "Exit");
 }
 
+/*
+ * Sleep until calibration may run: while the speaker is in use wait for
+ * the stop transition, then wait once for the rest of minIdleTime. A
+ * start in between sends us back to waiting for the next stop, so the
+ * thread wakes only on transitions and on the idle deadline.
+ */
+void SpeakerProtection::spkrWaitForCalWindow()
+{
+    std::unique_lock<std::mutex> lock(spkrUsageMutex);
+    int64_t wait = 0;
+
+    while (1) {
+        wait = spkrCalWindow.remaining(minIdleTime, isDynamicCalTriggered);
+        if (wait == 0)
+            break;
+        if (wait == SPKR_CAL_WAIT_STOP) {
+            spkrUsageCv.wait(lock);
+            continue;
+        }
+        PAL_DBG(LOG_TAG, "Calibration deadline in %lld sec", (long long)wait);
+        spkrUsageCv.wait_for(lock, std::chrono::seconds(wait));
+    }
+}
+
 /* Wait function for WAKEUP_MIN_IDLE_CHECK  */
 void SpeakerProtection::spkrCalibrateWait()
 {
@@ -358,7 +394,7 @@ int SpeakerProtection::getCpsDevNumber(std::string mixer_name)
 
 int SpeakerProtection::getSpeakerTemperature(int spkr_pos)
 {
-    struct mixer_ctl *ctl;
+    struct mixer_ctl *ctl = NULL;
     std::string mixer_ctl_name;
     int status = 0;
     /**
@@ -367,19 +403,33 @@ int SpeakerProtection::getSpeakerTemperature(int spkr_pos)
      * TODO: Get the channel from RM.xml
      */
     PAL_DBG(LOG_TAG, "Enter Speaker Get Temperature %d", spkr_pos);
-    mixer_ctl_name = rm->getSpkrTempCtrl(spkr_pos);
-    if (mixer_ctl_name.empty()) {
-        PAL_DBG(LOG_TAG, "Using default mixer control");
-        mixer_ctl_name = getDefaultSpkrTempCtrl(spkr_pos);
-    }
+    if (spkr_pos < 0)
+        return -EINVAL;
 
-    PAL_DBG(LOG_TAG, "audio_mixer %pK", hwMixer);
+    /* name lookup walks every control of the card, do it once per channel */
+    {
+        std::lock_guard<std::mutex> lock(spkrTempCtlsMutex);
 
-    ctl = mixer_get_ctl_by_name(hwMixer, mixer_ctl_name.c_str());
-    if (!ctl) {
-        PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_ctl_name.c_str());
-        status = -EINVAL;
-        return status;
+        if (spkrTempCtls.size() <= (size_t)spkr_pos)
+            spkrTempCtls.resize(spkr_pos + 1, NULL);
+        ctl = spkrTempCtls[spkr_pos];
+        if (!ctl) {
+            mixer_ctl_name = rm->getSpkrTempCtrl(spkr_pos);
+            if (mixer_ctl_name.empty()) {
+                PAL_DBG(LOG_TAG, "Using default mixer control");
+                mixer_ctl_name = getDefaultSpkrTempCtrl(spkr_pos);
+            }
+
+            PAL_DBG(LOG_TAG, "audio_mixer %pK", hwMixer);
+
+            ctl = mixer_get_ctl_by_name(hwMixer, mixer_ctl_name.c_str());
+            if (!ctl) {
+                PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_ctl_name.c_str());
+                status = -EINVAL;
+                return status;
+            }
+            spkrTempCtls[spkr_pos] = ctl;
+        }
     }
 
     status = mixer_ctl_get_value(ctl, 0);
@@ -1106,7 +1156,7 @@ int SpeakerProtection::spkrStartCalibration()
                 PAL_DBG(LOG_TAG, "Calibration is not done");
                 spkrCalState = SPKR_NOT_CALIBRATED;
                 // reset the timer for retry
-                clock_gettime(CLOCK_BOOTTIME, &spkrLastTimeUsed);
+                spkrCalWindow.restartIdle();
             }
         }
         cv.notify_all();
@@ -1175,13 +1225,13 @@ exit:
         // for the unlock. So notify it.
         PAL_DBG(LOG_TAG, "Unlocked due to processing mode");
         spkrCalState = SPKR_NOT_CALIBRATED;
-        clock_gettime(CLOCK_BOOTTIME, &spkrLastTimeUsed);
+        spkrCalWindow.restartIdle();
     }
     cv.notify_all();
 
     if (ret != 0) {
         // Error happened. Reset timer
-        clock_gettime(CLOCK_BOOTTIME, &spkrLastTimeUsed);
+        spkrCalWindow.restartIdle();
     }
 
     if(builder) {
@@ -1225,7 +1275,7 @@ void SpeakerProtection::spkrCalibrationThread()
         proceed = false;
         if (isSpeakerInUse(&sec)) {
             PAL_DBG(LOG_TAG, "Speaker in use. Wait for proper time");
-            spkrCalibrateWait();
+            spkrWaitForCalWindow();
             PAL_DBG(LOG_TAG, "Waiting done");
             continue;
         }
@@ -1236,7 +1286,7 @@ void SpeakerProtection::spkrCalibrationThread()
             }
             else if (sec < minIdleTime) {
                 PAL_DBG(LOG_TAG, "Speaker not idle for minimum time. %lu", sec);
-                spkrCalibrateWait();
+                spkrWaitForCalWindow();
                 PAL_DBG(LOG_TAG, "Waited for speaker to be idle for min time");
                 continue;
             }
@@ -1270,7 +1320,7 @@ void SpeakerProtection::spkrCalibrationThread()
         proceed = false;
         if (isSpeakerInUse(&sec)) {
             PAL_DBG(LOG_TAG, "Speaker in use. Wait for proper time");
-            spkrCalibrateWait();
+            spkrWaitForCalWindow();
             PAL_DBG(LOG_TAG, "Waiting done");
             continue;
         }
@@ -1281,7 +1331,7 @@ void SpeakerProtection::spkrCalibrationThread()
             }
             else if (sec < minIdleTime) {
                 PAL_DBG(LOG_TAG, "Speaker not idle for minimum time. %lu", sec);
-                spkrCalibrateWait();
+                spkrWaitForCalWindow();
                 PAL_DBG(LOG_TAG, "Waited for speaker to be idle for min time");
                 continue;
             }
@@ -1332,7 +1382,7 @@ SpeakerProtection::SpeakerProtection(struct pal_device *device,
     spkrCalState = SPKR_NOT_CALIBRATED;
     spkrProcessingState = SPKR_PROCESSING_IN_IDLE;
 
-    isSpkrInUse = false;
+    spkrCalWindow.setInUse(false);
 
     calibrationCallbackStatus = 0;
     mDspCallbackRcvd = false;
@@ -1354,7 +1404,7 @@ SpeakerProtection::SpeakerProtection(struct pal_device *device,
 
     spkerTempList = new int [numberOfChannels];
     // Get current time
-    clock_gettime(CLOCK_BOOTTIME, &spkrLastTimeUsed);
+    spkrCalWindow.restartIdle();
 
     // Getting mixture controls from Resource Manager
     status = rm->getVirtualAudioMixer(&virtMixer);
@@ -1365,6 +1415,10 @@ SpeakerProtection::SpeakerProtection(struct pal_device *device,
     if (status) {
         PAL_ERR(LOG_TAG,"hw mixer error %d", status);
     }
+    {
+        std::lock_guard<std::mutex> lock(spkrTempCtlsMutex);
+        spkrTempCtls.clear();
+    }
 
     if (device->id == PAL_DEVICE_OUT_HANDSET) {
         vi_device.channels = 1;
@@ -1401,22 +1455,19 @@ SpeakerProtection::~SpeakerProtection()
     customPayloadSize = 0;
 }
 
-int32_t SpeakerProtection::getSpkrXmaxTmaxData()
+/*
+ * Resolve the getParam control and SP module instance once per telemetry
+ * session; every sample afterwards is a single set/get round trip.
+ */
+int32_t SpeakerProtection::resolveSpkrXmaxTmaxCtl()
 {
     const char* getParamControl = "getParam";
     char* pcmDeviceName = NULL;
-    uint8_t* payload = NULL;
     int ret = 0;
-    uint32_t miid = 0, num_ch = 0, stringLen =0;
     int32_t pcmID = -EINVAL;
-    size_t payloadSize = 0, bytesWritten = -1;
     struct mixer_ctl* ctl;
-    FILE* fp;
     std::ostringstream cntrlName;
     std::string backendName;
-    param_id_sp_tmax_xmax_logging_t sp_xmax_tmax;
-    param_id_sp_tmax_xmax_logging_t* sp_xmax_tmax_value;
-    PayloadBuilder* builder = new PayloadBuilder();
 
     /* Frontend ID information for RX Session presents at SessionAlsaPCM/Compress
      * In Kalama, there is no getter func for pcmDevIds (private attribute)
@@ -1436,8 +1487,7 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
     }
     else {
         PAL_ERR(LOG_TAG, "Error: %d Unable to get Device name\n", -EINVAL);
-        ret = -EINVAL;
-        goto exit;
+        return -EINVAL;
     }
 
     ctl = mixer_get_ctl_by_name(virtMixer, cntrlName.str().data());
@@ -1445,7 +1495,7 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
     if (!ctl) {
         ret = -ENOENT;
         PAL_ERR(LOG_TAG, "Error: %d Invalid mixer control: %s\n", ret, cntrlName.str().data());
-        goto exit;
+        return ret;
     }
 
     rm->getBackendName(PAL_DEVICE_OUT_SPEAKER, backendName);
@@ -1453,20 +1503,44 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
     if (!strlen(backendName.c_str())) {
         ret = -ENOENT;
         PAL_ERR(LOG_TAG, "Error: %d Failed to obtain RX backend name", ret);
-        goto exit;
+        return ret;
     }
 
     ret = SessionAlsaUtils::getModuleInstanceId(virtMixer, pcmID,
-        backendName.c_str(), MODULE_SP, &miid);
+        backendName.c_str(), MODULE_SP, &xmaxTmaxMiid);
 
     if (0 != ret) {
         PAL_ERR(LOG_TAG, "Error: %d Failed to get tag info %x", ret, MODULE_SP);
-        goto exit;
+        return ret;
+    }
+    xmaxTmaxCtl = ctl;
+
+    return 0;
+}
+
+int32_t SpeakerProtection::getSpkrXmaxTmaxData()
+{
+    uint8_t* payload = NULL;
+    int ret = 0;
+    uint32_t num_ch = 0, stringLen =0;
+    size_t payloadSize = 0, bytesWritten = -1;
+    FILE* fp;
+    param_id_sp_tmax_xmax_logging_t sp_xmax_tmax;
+    param_id_sp_tmax_xmax_logging_t* sp_xmax_tmax_value;
+    pal_sp_telemetry_sample_t sample;
+    struct timespec now;
+    PayloadBuilder builder;
+    PayloadArena arena;
+
+    if (!xmaxTmaxCtl) {
+        ret = resolveSpkrXmaxTmaxCtl();
+        if (ret)
+            return ret;
     }
 
     sp_xmax_tmax.num_ch = vi_device.channels;
-    builder->payloadSPConfig(&payload, &payloadSize, miid,
-        PARAM_ID_SP_TMAX_XMAX_LOGGING, (void *) &sp_xmax_tmax);
+    builder.payloadSPConfig(&payload, &payloadSize, xmaxTmaxMiid,
+        PARAM_ID_SP_TMAX_XMAX_LOGGING, (void *) &sp_xmax_tmax, &arena);
 
     if (!payloadSize) {
         PAL_ERR(LOG_TAG, "Payload memory allocation failed");
@@ -1474,7 +1548,7 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
         goto exit;
     }
 
-    ret = mixer_ctl_set_array(ctl, payload, payloadSize);
+    ret = mixer_ctl_set_array(xmaxTmaxCtl, payload, payloadSize);
     if (0 != ret) {
         PAL_ERR(LOG_TAG, "Set failed with return value = %d", ret);
         goto exit;
@@ -1482,7 +1556,7 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
 
     memset(payload, 0, payloadSize);
 
-    ret = mixer_ctl_get_array(ctl, payload, payloadSize);
+    ret = mixer_ctl_get_array(xmaxTmaxCtl, payload, payloadSize);
     if (0 != ret) {
         PAL_ERR(LOG_TAG, "Get failed with return value = %d", ret);
         goto exit;
@@ -1490,6 +1564,18 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
     else {
         sp_xmax_tmax_value = (param_id_sp_tmax_xmax_logging_t*)(payload +
             sizeof(struct apm_module_param_data_t));
+        num_ch = sp_xmax_tmax_value->num_ch;
+
+        memset(&sample, 0, sizeof(sample));
+        clock_gettime(CLOCK_BOOTTIME, &now);
+        sample.timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+        sample.num_ch = std::min(num_ch, (uint32_t)PAL_SP_TELEMETRY_MAX_CH);
+        for (int i = 0; i < sample.num_ch; i++) {
+            sample.max_excursion[i] = sp_xmax_tmax_value->tmax_xmax_params[i].max_excursion;
+            sample.max_temperature[i] = sp_xmax_tmax_value->tmax_xmax_params[i].max_temperature;
+        }
+        publishTelemetry(&sample);
+
         fp = fopen(PAL_SP_XMAX_TMAX_DATA_PATH, "a");
 
         if (!fp) {
@@ -1498,7 +1584,6 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
             goto exit;
         }
         else {
-            num_ch = sp_xmax_tmax_value->num_ch;
             auto currentTime = std::chrono::system_clock::now();
             std::time_t currentTimeT = std::chrono::system_clock::to_time_t(currentTime);
             const char* currentTimeStr = std::ctime(&currentTimeT);
@@ -1546,42 +1631,123 @@ int32_t SpeakerProtection::getSpkrXmaxTmaxData()
         }
     }
 exit:
-    if (builder) {
-        delete builder;
-        builder = NULL;
-    }
     return ret;
 
 }
 
+/* Single writer: only the telemetry thread publishes */
+void SpeakerProtection::publishTelemetry(const pal_sp_telemetry_sample_t *sample)
+{
+    uint32_t head = telemetryHead.load(std::memory_order_relaxed);
+    struct spkr_telemetry_slot *slot = &telemetryRing[head % SPKR_TELEMETRY_RING_SIZE];
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot->sample, sample, sizeof(*sample));
+    slot->seq.store(seq + 2, std::memory_order_release);
+    telemetryHead.store(head + 1, std::memory_order_release);
+}
+
+/*
+ * Copy up to count of the most recent samples, newest first, without
+ * blocking the sampler. Returns the number of samples copied.
+ */
+int SpeakerProtection::getSpkrTelemetry(pal_sp_telemetry_sample_t *samples, int count)
+{
+    uint32_t head = telemetryHead.load(std::memory_order_acquire);
+    uint32_t seq1, seq2;
+    int copied = 0;
+
+    if (!samples || count <= 0)
+        return -EINVAL;
+
+    for (uint32_t i = 0; i < head && copied < count &&
+         i < SPKR_TELEMETRY_RING_SIZE; i++) {
+        struct spkr_telemetry_slot *slot =
+            &telemetryRing[(head - 1 - i) % SPKR_TELEMETRY_RING_SIZE];
+
+        seq1 = slot->seq.load(std::memory_order_acquire);
+        if (seq1 & 1)
+            break;
+        memcpy(&samples[copied], &slot->sample, sizeof(*samples));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = slot->seq.load(std::memory_order_relaxed);
+        /* overwritten while copying, older slots are stale too */
+        if (seq1 != seq2)
+            break;
+        copied++;
+    }
+
+    return copied;
+}
+
+/*
+ * Telemetry thread. Waits for the log trigger file and then samples
+ * Xmax/Tmax at the configured interval; both waits sleep on telemetryCv
+ * so stopXmaxTmaxTelemetry() wakes it at once.
+ */
 void SpeakerProtection::startSpkrXmaxTmaxLogging()
 {
-    FILE* log_fp = NULL;
     int32_t ret = 0;
+    int interval = ResourceManager::spXmaxTmaxLogInterval > 0 ?
+                   ResourceManager::spXmaxTmaxLogInterval :
+                   SPKR_XMAX_TMAX_LOG_INTERVAL_MS;
+    std::unique_lock<std::mutex> lock(telemetryMutex);
 
-    PAL_DBG(LOG_TAG, "Enter");
+    PAL_DBG(LOG_TAG, "Enter, interval %d ms", interval);
 
     /* This condition is added to know if the Speaker_RX graph started or not.
      * Assuming this file will be pushed to target after playback started
      * That's how, we will be sure Speaker_RX graph has been started */
 
-    while (!log_fp) {
-        log_fp = fopen(PAL_SP_XMAX_TMAX_LOG_PATH, "rb");
-    }
-    fclose(log_fp);
+    while (startXmaxLogging && access(PAL_SP_XMAX_TMAX_LOG_PATH, F_OK) != 0)
+        telemetryCv.wait_for(lock, std::chrono::milliseconds(interval));
+    if (!startXmaxLogging)
+        goto exit;
 
     if (remove(PAL_SP_XMAX_TMAX_LOG_PATH) == 0) {
         PAL_DBG(LOG_TAG, "log_spkr_xmax_tmax file deleted successfully");
     }
 
-    startXmaxLogging = true;
-    while (startXmaxLogging && (ret == 0)) {
+    xmaxTmaxCtl = NULL;
+    while (startXmaxLogging) {
+        lock.unlock();
         ret = getSpkrXmaxTmaxData();
+        lock.lock();
         if (ret != 0) {
             PAL_ERR(LOG_TAG, "Failed to get Param for spkr_xmax_tmax");
+            break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        telemetryCv.wait_for(lock, std::chrono::milliseconds(interval),
+                             [] { return !startXmaxLogging; });
     }
+
+exit:
+    PAL_DBG(LOG_TAG, "Exit ret %d", ret);
+}
+
+void SpeakerProtection::startXmaxTmaxTelemetry()
+{
+    /* reap a sampler that already ended on error */
+    stopXmaxTmaxTelemetry();
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        startXmaxLogging = true;
+    }
+    XmaxTmaxLogThread = std::thread(&SpeakerProtection::startSpkrXmaxTmaxLogging,
+        this);
+}
+
+void SpeakerProtection::stopXmaxTmaxTelemetry()
+{
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        startXmaxLogging = false;
+    }
+    telemetryCv.notify_all();
+    if (XmaxTmaxLogThread.joinable())
+        XmaxTmaxLogThread.join();
 }
 
 /*
@@ -2656,10 +2822,8 @@ cps_dev_setup:
             }
         }
 
-        if (ResourceManager::isSpkrXmaxTmaxLoggingEnabled) {
-            XmaxTmaxLogThread = std::thread(&SpeakerProtection::startSpkrXmaxTmaxLogging,
-                this);
-        }
+        if (ResourceManager::isSpkrXmaxTmaxLoggingEnabled)
+            startXmaxTmaxTelemetry();
         // Free up the local variables
         goto exit;
     }
@@ -2675,7 +2839,7 @@ cps_dev_setup:
         }
         spkrProtSetSpkrStatus(flag);
         // Speaker not in use anymore. Stop the processing mode
-        startXmaxLogging = false;
+        stopXmaxTmaxTelemetry();
 
         PAL_DBG(LOG_TAG, "Closing VI path");
         if (txPcm) {
@@ -3272,6 +3436,35 @@ int32_t SpeakerProtection::getCalibrationData(void **param)
 
 }
 
+/*
+ * Fills the caller's pal_param_sp_telemetry_t from the telemetry ring and
+ * returns the payload size used.
+ */
+int32_t SpeakerProtection::getTelemetryParameter(void **param)
+{
+    pal_param_sp_telemetry_t *telemetry = nullptr;
+    int copied = 0;
+
+    if (!param || !*param) {
+        PAL_ERR(LOG_TAG, "Invalid telemetry payload");
+        return -EINVAL;
+    }
+
+    telemetry = (pal_param_sp_telemetry_t *)(*param);
+    telemetry->num_samples = 0;
+    if (telemetry->max_samples == 0)
+        return sizeof(pal_param_sp_telemetry_t);
+
+    copied = getSpkrTelemetry(telemetry->samples, telemetry->max_samples);
+    if (copied < 0)
+        return copied;
+
+    telemetry->num_samples = copied;
+    PAL_DBG(LOG_TAG, "%d telemetry samples", copied);
+    return sizeof(pal_param_sp_telemetry_t) +
+           copied * sizeof(pal_sp_telemetry_sample_t);
+}
+
 int32_t SpeakerProtection::getParameter(uint32_t param_id, void **param)
 {
     int32_t status = 0;
@@ -3282,6 +3475,9 @@ int32_t SpeakerProtection::getParameter(uint32_t param_id, void **param)
         case PAL_PARAM_ID_SP_MODE:
             status = getFTMParameter(param);
         break;
+        case PAL_PARAM_ID_SP_GET_TELEMETRY:
+            status = getTelemetryParameter(param);
+        break;
         default :
             PAL_ERR(LOG_TAG, "Unsupported operation");
             status = -EINVAL;
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <time.h>
+#include "SpkrCalWindow.h"
+
+int64_t SpkrBootClock::nowSec()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return now.tv_sec;
+}
+
+SpkrCalWindow::SpkrCalWindow(SpkrCalClock *clock)
+    : inUse_(false),
+      lastUsedSec_(0)
+{
+    static SpkrBootClock bootClock;
+
+    clock_ = clock ? clock : &bootClock;
+}
+
+/* A stop transition starts the idle time */
+void SpkrCalWindow::setInUse(bool inUse)
+{
+    inUse_ = inUse;
+    if (!inUse)
+        lastUsedSec_ = clock_->nowSec();
+}
+
+/* Pushes the next calibration attempt out by a full idle time */
+void SpkrCalWindow::restartIdle()
+{
+    lastUsedSec_ = clock_->nowSec();
+}
+
+/* Seconds the speaker has been idle, 0 while it is in use */
+int64_t SpkrCalWindow::idleSec()
+{
+    int64_t idle = 0;
+
+    if (inUse_)
+        return 0;
+    idle = clock_->nowSec() - lastUsedSec_;
+    return idle > 0 ? idle : 0;
+}
+
+/*
+ * Returns 0 when calibration may run now, SPKR_CAL_WAIT_STOP while the
+ * speaker is in use, else the seconds left until the idle deadline.
+ */
+int64_t SpkrCalWindow::remaining(int64_t minIdleSec, bool dynamicCal)
+{
+    int64_t idle = 0;
+
+    if (inUse_)
+        return SPKR_CAL_WAIT_STOP;
+    if (dynamicCal)
+        return 0;
+    idle = idleSec();
+    return idle >= minIdleSec ? 0 : minIdleSec - idle;
+}
@@ -66,14 +66,33 @@
 
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
 #include "USBAudio.h"
 #include "ResourceManager.h"
 #include "PayloadBuilder.h"
 #include "Device.h"
 #include "kvh2xml.h"
+#include "PalExecutor.h"
 #include <unistd.h>
 
 std::shared_ptr<Device> USB::objRx = nullptr;
+std::map<std::string, usb_caps_cache_entry> USBCardConfig::caps_cache_;
+std::mutex USBCardConfig::caps_cache_mutex_;
+std::mutex USBCardConfig::caps_cache_file_mutex_;
+bool USBCardConfig::caps_cache_loaded_ = false;
+uint64_t USBCardConfig::caps_cache_clock_ = 0;
+
+/* 32-bit FNV-1a, only compared against hashes this file stored */
+static uint32_t usbDescHash(const std::string &data)
+{
+    uint32_t hash = 2166136261U;
+
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 16777619U;
+    }
+    return hash;
+}
 std::shared_ptr<Device> USB::objTx = nullptr;
 
 std::shared_ptr<Device> USB::getInstance(struct pal_device *device,
@@ -263,13 +282,14 @@ int USB::init(pal_param_device_connection_t device_conn)
             PAL_ERR(LOG_TAG, "failed to create new usb_card_config object.");
             return -EINVAL;
         }
-        if (isUSBOutDevice(device_conn.id))
-            ret = sp->getCapability(USB_PLAYBACK, device_conn.device_config.usb_addr);
-        else
-            ret = sp->getCapability(USB_CAPTURE, device_conn.device_config.usb_addr);
+        usb_usecase_type_t type = isUSBOutDevice(device_conn.id) ?
+                                  USB_PLAYBACK : USB_CAPTURE;
 
-        if (ret == 0)
+        ret = sp->getCapability(type, device_conn.device_config.usb_addr);
+        if (ret == 0) {
             usb_card_config_list_.push_back(sp);
+            sp->startJackStatusProbe(type);
+        }
     } else {
         PAL_INFO(LOG_TAG, "usb info has been cached.");
     }
@@ -453,8 +473,9 @@ int USBCardConfig::getCapability(usb_usecase_type_t type,
     int ret = 0;
     char *bit_width_str = NULL;
     size_t num_read = 0;
-    const char* suffix;
-    bool jack_status;
+    std::string cache_key;
+    uint32_t desc_hash = 0;
+    bool cacheable = false;
     //std::shared_ptr<USBDeviceConfig> usb_device_info = nullptr;
 
     bool check = false;
@@ -501,6 +522,18 @@ int USBCardConfig::getCapability(usb_usecase_type_t type,
         goto done;
     }
 
+    /* a known device with unchanged descriptors skips the altset parsing */
+    if (readUsbId(addr.card_id, cache_key) == 0) {
+        cache_key += (type == USB_PLAYBACK) ? ":P" : ":C";
+        desc_hash = getDescriptorHash(read_buf);
+        cacheable = true;
+        if (restoreCapability(type, cache_key, desc_hash)) {
+            PAL_INFO(LOG_TAG, "capabilities of %s restored from cache",
+                     cache_key.c_str());
+            goto done;
+        }
+    }
+
     str_end = strstr(read_buf, ((type == USB_PLAYBACK) ?
                        CAPTURE_PROFILE_STR : PLAYBACK_PROFILE_STR));
 
@@ -604,12 +637,6 @@ int USBCardConfig::getCapability(usb_usecase_type_t type,
                 PAL_INFO(LOG_TAG, "error unable to get service interval, assume default");
             }
         }
-        /* jack status parsing */
-        suffix = (type == USB_PLAYBACK) ? USB_OUT_JACK_SUFFIX : USB_IN_JACK_SUFFIX;
-        jack_status = getJackConnectionStatus(addr.card_id, suffix);
-        PAL_DBG(LOG_TAG, "jack_status %d", jack_status);
-        usb_device_info->setJackStatus(jack_status);
-
         /* Add to list if every field is valid */
         usb_device_config_list_.push_back(usb_device_info);
         format_list_map.insert( std::pair<int, std::shared_ptr<USBDeviceConfig>>(usb_device_info->getBitWidth(),usb_device_info));
@@ -617,6 +644,9 @@ int USBCardConfig::getCapability(usb_usecase_type_t type,
 
      usb_info_dump(read_buf, type);
 
+    if (ret == 0 && cacheable)
+        saveCapability(type, cache_key, desc_hash);
+
 done:
     if (fd)
         fclose(fd);
@@ -627,6 +657,253 @@ done:
     return ret;
 }
 
+int USBCardConfig::readUsbId(int card, std::string &usbid) {
+    char path[128];
+    char buf[USBID_SIZE + 1] = {0};
+    char *eol = NULL;
+    FILE *fd = NULL;
+
+    snprintf(path, sizeof(path), "/proc/asound/card%u/usbid", card);
+    fd = fopen(path, "r");
+    if (!fd) {
+        PAL_INFO(LOG_TAG, "no usbid for card %d, capability cache bypassed", card);
+        return -ENOENT;
+    }
+    if (!fgets(buf, sizeof(buf), fd)) {
+        fclose(fd);
+        return -EINVAL;
+    }
+    fclose(fd);
+
+    eol = strchr(buf, '\n');
+    if (eol)
+        *eol = '\0';
+    if (buf[0] == '\0' || strchr(buf, ' '))
+        return -EINVAL;
+
+    usbid = buf;
+    return 0;
+}
+
+/*
+ * Hash the descriptor part of stream0. The first line carries the bus
+ * path and the "key = value" lines are live endpoint state, so both are
+ * left out to keep the hash stable across ports and running streams.
+ */
+uint32_t USBCardConfig::getDescriptorHash(const char *read_buf) {
+    std::string desc;
+    const char *line = strchr(read_buf, '\n');
+    const char *eol = NULL;
+    std::string cur;
+
+    while (line && *(++line) != '\0') {
+        eol = strchr(line, '\n');
+        cur.assign(line, eol ? (size_t)(eol - line) : strlen(line));
+        if (cur.find(" = ") == std::string::npos &&
+            cur.find("Status:") == std::string::npos) {
+            desc += cur;
+            desc += '\n';
+        }
+        line = eol;
+    }
+
+    return usbDescHash(desc);
+}
+
+bool USBCardConfig::restoreCapability(usb_usecase_type_t type,
+                                      const std::string &key, uint32_t hash) {
+    std::lock_guard<std::mutex> lock(caps_cache_mutex_);
+    std::map<std::string, usb_caps_cache_entry>::iterator it;
+
+    if (!caps_cache_loaded_) {
+        loadCapsCache();
+        caps_cache_loaded_ = true;
+    }
+
+    it = caps_cache_.find(key);
+    if (it == caps_cache_.end())
+        return false;
+    if (it->second.desc_hash != hash || it->second.altsets.empty()) {
+        PAL_INFO(LOG_TAG, "descriptors of %s changed, reparsing", key.c_str());
+        caps_cache_.erase(it);
+        return false;
+    }
+    it->second.last_used = ++caps_cache_clock_;
+
+    for (auto &caps : it->second.altsets) {
+        std::shared_ptr<USBDeviceConfig> usb_device_info(new USBDeviceConfig());
+
+        usb_device_info->setType(type);
+        usb_device_info->setBitWidth(caps.bit_width);
+        usb_device_info->setChannels(caps.channels);
+        usb_device_info->setInterval(caps.interval);
+        usb_device_info->setSampleRates(type, caps.rates);
+        usb_device_config_list_.push_back(usb_device_info);
+        format_list_map.insert(std::pair<int, std::shared_ptr<USBDeviceConfig>>(
+                               caps.bit_width, usb_device_info));
+    }
+    setEndian(it->second.endian);
+
+    return true;
+}
+
+void USBCardConfig::saveCapability(usb_usecase_type_t type,
+                                   const std::string &key, uint32_t hash) {
+    usb_caps_cache_entry entry;
+    typename std::vector<std::shared_ptr<USBDeviceConfig>>::iterator iter;
+
+    entry.desc_hash = hash;
+    entry.endian = endian_;
+    for (iter = usb_device_config_list_.begin();
+         iter != usb_device_config_list_.end(); iter++) {
+        if ((*iter)->getType() != type)
+            continue;
+        usb_altset_caps caps;
+        caps.type = type;
+        caps.bit_width = (*iter)->getBitWidth();
+        caps.channels = (*iter)->getChannels();
+        caps.interval = (*iter)->getInterval();
+        caps.rates = (*iter)->getSampleRates();
+        entry.altsets.push_back(caps);
+    }
+    if (entry.altsets.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(caps_cache_mutex_);
+
+        /* full: evict the entry saved or restored longest ago */
+        if (caps_cache_.find(key) == caps_cache_.end() &&
+            caps_cache_.size() >= USB_CAPS_CACHE_MAX_ENTRIES)
+            caps_cache_.erase(std::min_element(caps_cache_.begin(), caps_cache_.end(),
+                [](const std::pair<const std::string, usb_caps_cache_entry> &a,
+                   const std::pair<const std::string, usb_caps_cache_entry> &b) {
+                    return a.second.last_used < b.second.last_used;
+                }));
+        entry.last_used = ++caps_cache_clock_;
+        caps_cache_[key] = entry;
+    }
+    PalExecutor::getInstance()->post([] { storeCapsCache(); });
+}
+
+/*
+ * File format, one altset per line after the version header:
+ *   <vid:pid> <P|C> <desc hash> <endian> <bit width> <channels> <interval> <n> <rate>...
+ * n may be 0: an altset none of whose rates is in supported_sample_rates_
+ * is kept by the parser, so it is stored and restored the same way.
+ * Entries are written least recently used first, which is how the LRU
+ * order survives a reload. Called with caps_cache_mutex_ held.
+ */
+void USBCardConfig::loadCapsCache() {
+    FILE *fd = NULL;
+    char line[512];
+    unsigned int version = 0;
+
+    fd = fopen(USB_CAPS_CACHE_FILE, "r");
+    if (!fd) {
+        PAL_INFO(LOG_TAG, "no usb capability cache at %s", USB_CAPS_CACHE_FILE);
+        return;
+    }
+    if (!fgets(line, sizeof(line), fd) ||
+        sscanf(line, "usbcaps %u", &version) != 1 ||
+        version != USB_CAPS_CACHE_VERSION) {
+        PAL_INFO(LOG_TAG, "usb capability cache is stale, ignoring it");
+        goto exit;
+    }
+
+    while (fgets(line, sizeof(line), fd)) {
+        char usbid[USBID_SIZE + 1] = {0};
+        char dir = 0;
+        uint32_t hash = 0;
+        int endian = 0, consumed = 0;
+        unsigned int nrates = 0, rate = 0;
+        usb_altset_caps caps;
+        const char *cur = NULL;
+
+        if (sscanf(line, "%16s %c %x %d %u %u %lu %u%n", usbid, &dir, &hash,
+                   &endian, &caps.bit_width, &caps.channels, &caps.interval,
+                   &nrates, &consumed) != 8 ||
+            (dir != 'P' && dir != 'C') || caps.channels == 0 ||
+            nrates > MAX_SAMPLE_RATE_SIZE) {
+            PAL_ERR(LOG_TAG, "malformed usb capability cache line, dropping cache");
+            caps_cache_.clear();
+            break;
+        }
+        cur = line + consumed;
+        for (unsigned int i = 0; i < nrates; i++) {
+            if (sscanf(cur, " %u%n", &rate, &consumed) != 1)
+                break;
+            caps.rates.push_back(rate);
+            cur += consumed;
+        }
+        if (caps.rates.size() != nrates) {
+            PAL_ERR(LOG_TAG, "truncated usb capability cache line, dropping cache");
+            caps_cache_.clear();
+            break;
+        }
+        caps.type = (dir == 'P') ? USB_PLAYBACK : USB_CAPTURE;
+
+        usb_caps_cache_entry &entry = caps_cache_[std::string(usbid) + ":" + dir];
+        if (entry.altsets.empty())
+            entry.last_used = ++caps_cache_clock_;
+        entry.desc_hash = hash;
+        entry.endian = endian;
+        entry.altsets.push_back(caps);
+    }
+    PAL_INFO(LOG_TAG, "loaded %zu usb capability entries", caps_cache_.size());
+
+exit:
+    fclose(fd);
+}
+
+void USBCardConfig::storeCapsCache() {
+    std::lock_guard<std::mutex> fileLock(caps_cache_file_mutex_);
+    std::vector<std::pair<std::string, usb_caps_cache_entry>> snapshot;
+    std::string tmpFile = std::string(USB_CAPS_CACHE_FILE) + ".tmp";
+    FILE *fd = NULL;
+    bool ok = true;
+
+    {
+        std::lock_guard<std::mutex> lock(caps_cache_mutex_);
+        snapshot.assign(caps_cache_.begin(), caps_cache_.end());
+    }
+    std::sort(snapshot.begin(), snapshot.end(),
+        [](const std::pair<std::string, usb_caps_cache_entry> &a,
+           const std::pair<std::string, usb_caps_cache_entry> &b) {
+            return a.second.last_used < b.second.last_used;
+        });
+
+    /* write aside and rename so a reader never sees a partial file */
+    fd = fopen(tmpFile.c_str(), "w");
+    if (!fd) {
+        PAL_INFO(LOG_TAG, "cannot create usb capability cache %s: %s",
+                 tmpFile.c_str(), strerror(errno));
+        return;
+    }
+    ok = fprintf(fd, "usbcaps %u\n", USB_CAPS_CACHE_VERSION) > 0;
+    for (auto &it : snapshot) {
+        /* key is "vid:pid:dir" */
+        std::string usbid = it.first.substr(0, it.first.size() - 2);
+        char dir = it.first.back();
+
+        for (auto &caps : it.second.altsets) {
+            ok = ok && fprintf(fd, "%s %c %x %d %u %u %lu %zu", usbid.c_str(), dir,
+                               it.second.desc_hash, it.second.endian, caps.bit_width,
+                               caps.channels, caps.interval, caps.rates.size()) > 0;
+            for (unsigned int rate : caps.rates)
+                ok = ok && fprintf(fd, " %u", rate) > 0;
+            ok = ok && fputc('\n', fd) != EOF;
+        }
+    }
+    ok = (fclose(fd) == 0) && ok;
+    if (!ok || rename(tmpFile.c_str(), USB_CAPS_CACHE_FILE)) {
+        PAL_ERR(LOG_TAG, "failed to write usb capability cache %s", USB_CAPS_CACHE_FILE);
+        unlink(tmpFile.c_str());
+        return;
+    }
+    PAL_DBG(LOG_TAG, "usb capability cache written, %zu entries", snapshot.size());
+}
+
 USBCardConfig::USBCardConfig(struct pal_usb_device_address address) {
     address_ = address;
 }
@@ -788,9 +1065,46 @@ void USBCardConfig::readSupportedChannelMask(bool is_playback, uint32_t *channel
             is_playback ? "P" : "C", channels, channel[0]);
 }
 
+/*
+ * Reading the jack control opens the card mixer, which enumerates every
+ * USB control over the bus. Do it once per direction on the shared
+ * executor instead of once per altset on the connection path.
+ */
+void USBCardConfig::startJackStatusProbe(usb_usecase_type_t type) {
+    std::shared_ptr<USBCardConfig> self = shared_from_this();
+
+    {
+        std::lock_guard<std::mutex> lock(jack_mutex_);
+        jack_probe_pending_ = true;
+    }
+    PalExecutor::getInstance()->post([self, type] {
+        self->probeJackStatus(type);
+    });
+}
+
+void USBCardConfig::probeJackStatus(usb_usecase_type_t type) {
+    const char *suffix = (type == USB_PLAYBACK) ? USB_OUT_JACK_SUFFIX : USB_IN_JACK_SUFFIX;
+    bool jack_status = getJackConnectionStatus(address_.card_id, suffix);
+    typename std::vector<std::shared_ptr<USBDeviceConfig>>::iterator iter;
+
+    PAL_DBG(LOG_TAG, "card %d jack_status %d", address_.card_id, jack_status);
+    std::lock_guard<std::mutex> lock(jack_mutex_);
+    for (iter = usb_device_config_list_.begin();
+         iter != usb_device_config_list_.end(); iter++) {
+        if ((*iter)->getType() == type)
+            (*iter)->setJackStatus(jack_status);
+    }
+    jack_probe_pending_ = false;
+    jack_cond_.notify_all();
+}
+
 bool USBCardConfig::readDefaultJackStatus(bool is_playback) {
     bool jack_status = true;
     typename std::vector<std::shared_ptr<USBDeviceConfig>>::iterator iter;
+    std::unique_lock<std::mutex> lock(jack_mutex_);
+
+    jack_cond_.wait_for(lock, std::chrono::milliseconds(USB_JACK_PROBE_TIMEOUT_MS),
+                        [&] { return !jack_probe_pending_; });
 
     for (iter = usb_device_config_list_.begin();
         iter != usb_device_config_list_.end(); iter++) {
@@ -1109,6 +1423,21 @@ int USBDeviceConfig::getSampleRates(int type, char *rates_str) {
     return 0;
 }
 
+void USBDeviceConfig::setSampleRates(usb_usecase_type_t type,
+                                     const std::vector<unsigned int> &rates) {
+    rates_.clear();
+    supported_sample_rates_mask_[type] = 0;
+    for (unsigned int sr : rates) {
+        for (unsigned int i = 0; i < MAX_SAMPLE_RATE_SIZE; i++) {
+            if (supported_sample_rates_[i] == sr) {
+                rates_.push_back(sr);
+                supported_sample_rates_mask_[type] |= (1<<i);
+                break;
+            }
+        }
+    }
+}
+
 int USBDeviceConfig::getServiceInterval(const char *interval_str_start)
 {
     unsigned long interval = 0;
@@ -969,6 +969,9 @@ typedef enum {
     PAL_PARAM_ID_ULTRASOUND_RAMPDOWN = 62,
     PAL_PARAM_ID_VOLUME_CTRL_RAMP = 63,
     PAL_PARAM_ID_ULTRASOUND_SET_GAIN = 64,
+    PAL_PARAM_ID_SP_GET_TELEMETRY = 65,
+    PAL_PARAM_ID_FE_POOL_STATS = 66,
+    PAL_PARAM_ID_MIXER_EVENT_LATENCY = 67,
 } pal_param_id_type_t;
 
 /** HDMI/DP */
@@ -1098,6 +1101,61 @@ typedef struct pal_param_device_rotation {
     pal_speaker_rotation_type    rotation_type;
 } pal_param_device_rotation_t;
 
+#define PAL_SP_TELEMETRY_MAX_CH 4
+
+/* One speaker protection Xmax/Tmax reading of all channels, in the DSP
+ * formats: excursion Q27, temperature Q22. timestamp_ns is CLOCK_BOOTTIME.
+ */
+typedef struct pal_sp_telemetry_sample {
+    uint64_t timestamp_ns;
+    uint32_t num_ch;
+    int32_t max_excursion[PAL_SP_TELEMETRY_MAX_CH];
+    int32_t max_temperature[PAL_SP_TELEMETRY_MAX_CH];
+} pal_sp_telemetry_sample_t;
+
+/* Payload For ID: PAL_PARAM_ID_SP_GET_TELEMETRY
+ * Description   : most recent speaker protection readings, newest first.
+ *                 Caller sets max_samples to the room in samples[].
+ */
+typedef struct pal_param_sp_telemetry {
+    uint32_t max_samples;
+    uint32_t num_samples;
+    pal_sp_telemetry_sample_t samples[];
+} pal_param_sp_telemetry_t;
+
+#define PAL_FE_POOL_NAME_LEN 32
+
+/* Occupancy of one front end id pool since the pools were set up */
+typedef struct pal_fe_pool_stats {
+    char name[PAL_FE_POOL_NAME_LEN];
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t failures;
+} pal_fe_pool_stats_t;
+
+/* Payload For ID: PAL_PARAM_ID_FE_POOL_STATS
+ * Description   : occupancy of every front end id pool.
+ *                 Caller sets max_pools to the room in pools[].
+ */
+typedef struct pal_param_fe_pool_stats {
+    uint32_t max_pools;
+    uint32_t num_pools;
+    pal_fe_pool_stats_t pools[];
+} pal_param_fe_pool_stats_t;
+
+#define PAL_MIXER_EVENT_LATENCY_BUCKETS 16
+
+/* Payload For ID: PAL_PARAM_ID_MIXER_EVENT_LATENCY
+ * Description   : time from a mixer event being read to its client callback
+ *                 starting, as a log2 histogram since boot. count[i] holds
+ *                 latencies of 2^i us up to 2^(i+1) us (bucket 0 from 0 us);
+ *                 the last bucket also holds everything longer.
+ */
+typedef struct pal_param_mixer_event_latency {
+    uint64_t count[PAL_MIXER_EVENT_LATENCY_BUCKETS];
+} pal_param_mixer_event_latency_t;
+
 /* Payload For ID: PAL_PARAM_ID_UHQA_FLAG
  * Description   : use to enable/disable USB high quality audio from userend
 */
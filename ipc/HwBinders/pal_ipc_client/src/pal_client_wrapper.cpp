@@ -598,7 +598,7 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
             return ret;
 
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
+        buf_hidl.resize(1);
         PalBuffer *palBuff = buf_hidl.data();
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
@@ -611,15 +611,17 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
 
         palBuff->size = buf->size;
         palBuff->offset = buf->offset;
-        palBuff->buffer.resize(buf->size);
+        /* reference the caller's buffer, it is only read during the call */
+        if (buf->size && buf->buffer)
+            palBuff->buffer.setToExternal((uint8_t *)buf->buffer, buf->size);
+        else
+            palBuff->buffer.resize(buf->size);
         palBuff->flags = buf->flags;
         palBuff->frame_index = buf->frame_index;
         if (buf->ts) {
              palBuff->timeStamp.tvSec = buf->ts->tv_sec;
              palBuff->timeStamp.tvNSec = buf->ts->tv_nsec;
         }
-        if (buf->size && buf->buffer)
-            memcpy(palBuff->buffer.data(), buf->buffer, buf->size);
          palBuff->alloc_info.alloc_handle =
                  hidl_memory("arpal_alloc_handle", hidl_handle(allocHidlHandle),
                               buf->alloc_info.alloc_size);
@@ -647,7 +649,7 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
             return ret;
 
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
+        buf_hidl.resize(1);
         PalBuffer *palBuff = buf_hidl.data();
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
@@ -44,6 +44,8 @@
 #include <utils/Thread.h>
 #include <utils/RefBase.h>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include "PalApi.h"
 #include<log/log.h>
 
@@ -82,9 +84,16 @@ class SrvrClbk : public ::android::RefBase {
     int pid_;
     bool client_died;
     std::vector<std::pair<int, int>> sharedMemFdList;
+    std::mutex mFdListLock; /* guards sharedMemFdList */
     std::unique_ptr<DataMQ> mDataMQ = nullptr;
     std::unique_ptr<CommandMQ> mCommandMQ = nullptr;
     EventFlag* mEfGroup = nullptr;
+    /*
+     * Buffers reused by every ipc_pal_stream_write/read of this session.
+     * Metadata is sized at open, read data grows to the largest request.
+     */
+    std::vector<uint8_t> mWriteMetadata;
+    std::vector<uint8_t> mReadData;
 
     SrvrClbk()
     {
@@ -104,6 +113,10 @@ class SrvrClbk : public ::android::RefBase {
     {
         memcpy(&session_attr, attr, sizeof(session_attr));
     }
+    void prepareTransferBuffers(size_t writeMetadataSize)
+    {
+        mWriteMetadata.assign(writeMetadataSize, 0);
+    }
     int32_t callReadWriteTransferThread(PalReadWriteDoneCommand cmd,
                             const uint8_t* data, size_t dataSize);
     int32_t prepare_mq_for_transfer(uint64_t streamHandle, uint64_t cookie);
@@ -217,11 +230,20 @@ struct PAL : public IPAL /*, public android::hardware::hidl_death_recipient*/{
                                      ipc_pal_stream_get_tags_with_module_info_cb _hidl_cb) override;
     sp<PalClientDeathRecipient> mDeathRecipient;
     std::vector<std::shared_ptr<client_info>> mPalClients;
+    sp<SrvrClbk> getSessionCallback(const uint64_t streamHandle);
+    void addSession(const uint64_t streamHandle, const sp<SrvrClbk>& session);
+    void removeSession(const uint64_t streamHandle);
 private:
     static PAL* sInstance;
     int find_dup_fd_from_input_fd(const uint64_t streamHandle, int input_fd, int *dup_fd);
-    void add_input_and_dup_fd(const uint64_t streamHandle, int input_fd, int dup_fd);
-    bool isValidstreamHandle(const uint64_t streamHandle);
+    void add_input_and_dup_fd(const sp<SrvrClbk>& session, int input_fd, int dup_fd);
+    bool isValidstreamHandle(const uint64_t streamHandle, sp<SrvrClbk> *session = nullptr);
+    /*
+     * Every open session keyed by its handle, so per call lookups do not
+     * need mClientLock or a walk over all clients.
+     */
+    std::unordered_map<uint64_t, sp<SrvrClbk>> mSessionMap;
+    std::shared_timed_mutex mSessionMapLock;
 };
 
 class PalClientDeathRecipient : public android::hardware::hidl_death_recipient
@@ -35,6 +35,7 @@
 #include "inc/pal_server_wrapper.h"
 #include "MetadataParser.h"
 #include <hwbinder/IPCThreadState.h>
+#include <algorithm>
 
 #define MAX_CACHE_SIZE 64
 
@@ -113,13 +114,17 @@ void PalClientDeathRecipient::serviceDied(uint64_t cookie,
                    ALOGD("Closing the session %pK", sItr->session_handle);
                    ALOGV("hdle %x binder %p", sItr->session_handle, sItr->callback_binder.get());
                    sItr->callback_binder->client_died = true;
+                   mPalInstance->removeSession(sItr->session_handle);
                    pal_stream_stop((pal_stream_handle_t *)sItr->session_handle);
                    pal_stream_close((pal_stream_handle_t *)sItr->session_handle);
                    /*close the dupped fds in PAL server context*/
-                   for (int i = 0; i < sItr->callback_binder->sharedMemFdList.size(); i++) {
-                       close(sItr->callback_binder->sharedMemFdList[i].second);
+                   {
+                       std::lock_guard<std::mutex> fdLock(sItr->callback_binder->mFdListLock);
+                       for (int i = 0; i < sItr->callback_binder->sharedMemFdList.size(); i++) {
+                           close(sItr->callback_binder->sharedMemFdList[i].second);
+                       }
+                       sItr->callback_binder->sharedMemFdList.clear();
                    }
-                   sItr->callback_binder->sharedMemFdList.clear();
                    sItr->callback_binder.clear();
                 }
                 client->mActiveSessions.clear();
@@ -130,26 +135,36 @@ void PalClientDeathRecipient::serviceDied(uint64_t cookie,
     }
 }
 
-void PAL::add_input_and_dup_fd(const uint64_t streamHandle, int input_fd, int dup_fd)
+void PAL::add_input_and_dup_fd(const sp<SrvrClbk>& session, int input_fd, int dup_fd)
 {
-    std::vector<std::pair<int, int>>::iterator it;
-    std::lock_guard<std::mutex> guard(mClientLock);
-    for (auto& s: mPalClients) {
-        std::lock_guard<std::mutex> lock(s->mActiveSessionsLock);
-        for (int i = 0; i < s->mActiveSessions.size(); i++) {
-            session_info session = s->mActiveSessions[i];
-            if (session.session_handle == streamHandle) {
-                /*If number of FDs increase than the MAX Cache size we delete the oldest one
-                  NOTE: We still create a new fd for every input fd*/
-                if (session.callback_binder->sharedMemFdList.size() > MAX_CACHE_SIZE) {
-                    ALOGE("%s cache limit exceeded handle %p fd [input %d - dup %d]",
-                            __func__ , streamHandle, input_fd, dup_fd );
-                }
-                session.callback_binder->sharedMemFdList.push_back(
-                                            std::make_pair(input_fd, dup_fd));
-            }
-        }
+    std::lock_guard<std::mutex> guard(session->mFdListLock);
+    /*If number of FDs increase than the MAX Cache size we delete the oldest one
+      NOTE: We still create a new fd for every input fd*/
+    if (session->sharedMemFdList.size() > MAX_CACHE_SIZE) {
+        ALOGE("%s cache limit exceeded fd [input %d - dup %d]",
+                __func__ , input_fd, dup_fd );
     }
+    session->sharedMemFdList.push_back(std::make_pair(input_fd, dup_fd));
+}
+
+sp<SrvrClbk> PAL::getSessionCallback(const uint64_t streamHandle)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mSessionMapLock);
+    auto it = mSessionMap.find(streamHandle);
+
+    return (it != mSessionMap.end()) ? it->second : nullptr;
+}
+
+void PAL::addSession(const uint64_t streamHandle, const sp<SrvrClbk>& session)
+{
+    std::unique_lock<std::shared_timed_mutex> lock(mSessionMapLock);
+    mSessionMap[streamHandle] = session;
+}
+
+void PAL::removeSession(const uint64_t streamHandle)
+{
+    std::unique_lock<std::shared_timed_mutex> lock(mSessionMapLock);
+    mSessionMap.erase(streamHandle);
 }
 
 
@@ -241,24 +256,12 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
                             uint32_t event_data_size,
                             uint64_t cookie)
 {
-    auto isPalSessionActive = [&](const uint64_t stream_handle) {
-        if (!PAL::getInstance()) {
-           ALOGE("%s: No PAL instance running", __func__);
-           return false;
-        }
-        std::lock_guard<std::mutex> guard(PAL::getInstance()->mClientLock);
-        for (auto& s: PAL::getInstance()->mPalClients) {
-            std::lock_guard<std::mutex> lock(s->mActiveSessionsLock);
-            for (int idx = 0; idx < s->mActiveSessions.size(); idx++) {
-                session_info session = s->mActiveSessions[idx];
-                if (session.session_handle == stream_handle)
-                    return true;
-            }
-        }
-        return false;
-    };
+    if (!PAL::getInstance()) {
+        ALOGE("%s: No PAL instance running", __func__);
+        return -EINVAL;
+    }
 
-    if (!isPalSessionActive((uint64_t)stream_handle)) {
+    if (!PAL::getInstance()->getSessionCallback((uint64_t)stream_handle)) {
         ALOGE("%s: PAL session %pK is no longer active", __func__, stream_handle);
         return -EINVAL;
     }
@@ -280,31 +283,23 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
          * Find the original fd that was passed by client based on what
          * input and dup fd list and send that back.
          */
-        PAL::getInstance()->mClientLock.lock();
-        for (auto& s: PAL::getInstance()->mPalClients) {
-            std::lock_guard<std::mutex> lock(s->mActiveSessionsLock);
-            for (int idx = 0; idx < s->mActiveSessions.size(); idx++) {
-                session_info session = s->mActiveSessions[idx];
-                if (session.session_handle != (uint64_t)stream_handle) {
-                    continue;
-                }
-                std::vector<std::pair<int, int>>::iterator it;
-                for (int i = 0; i < sr_clbk_dat->sharedMemFdList.size(); i++) {
-                    if (sr_clbk_dat->sharedMemFdList[i].second ==
-                            rw_done_payload->buff.alloc_info.alloc_handle) {
-                        input_fd = sr_clbk_dat->sharedMemFdList[i].first;
-                        it = (sr_clbk_dat->sharedMemFdList.begin() + i);
-                        if (it != sr_clbk_dat->sharedMemFdList.end()) {
-                            fdToBeClosed = sr_clbk_dat->sharedMemFdList[i].second;
-                            sr_clbk_dat->sharedMemFdList.erase(it);
-                            ALOGV("Removing fd [input %d - dup %d]", input_fd, fdToBeClosed);
-                        }
-                        break;
+        {
+            std::lock_guard<std::mutex> fdLock(sr_clbk_dat->mFdListLock);
+            std::vector<std::pair<int, int>>::iterator it;
+            for (int i = 0; i < sr_clbk_dat->sharedMemFdList.size(); i++) {
+                if (sr_clbk_dat->sharedMemFdList[i].second ==
+                        rw_done_payload->buff.alloc_info.alloc_handle) {
+                    input_fd = sr_clbk_dat->sharedMemFdList[i].first;
+                    it = (sr_clbk_dat->sharedMemFdList.begin() + i);
+                    if (it != sr_clbk_dat->sharedMemFdList.end()) {
+                        fdToBeClosed = sr_clbk_dat->sharedMemFdList[i].second;
+                        sr_clbk_dat->sharedMemFdList.erase(it);
+                        ALOGV("Removing fd [input %d - dup %d]", input_fd, fdToBeClosed);
                     }
+                    break;
                 }
             }
         }
-        PAL::getInstance()->mClientLock.unlock();
 
         rwDonePayloadHidl.resize(sizeof(pal_callback_buffer));
         rwDonePayload = (PalCallbackBuffer *)rwDonePayloadHidl.data();
@@ -450,30 +445,19 @@ static void print_attr(struct pal_stream_attributes *attr)
    print_media_config(&attr->out_media_config);
 }
 
-bool PAL::isValidstreamHandle(const uint64_t streamHandle) {
+bool PAL::isValidstreamHandle(const uint64_t streamHandle, sp<SrvrClbk> *session) {
     int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    sp<SrvrClbk> sr_clbk_dat = getSessionCallback(streamHandle);
 
-    std::lock_guard<std::mutex> guard(mClientLock);
-    for (auto itr = mPalClients.begin(); itr != mPalClients.end(); ) {
-        auto client = *itr;
-        if (client->pid == pid) {
-            std::lock_guard<std::mutex> lock(client->mActiveSessionsLock);
-            auto sItr = client->mActiveSessions.begin();
-            for (; sItr != client->mActiveSessions.end(); sItr++) {
-                if (sItr->session_handle == streamHandle) {
-                    return true;
-                }
-            }
-            ALOGE("%s: streamHandle: %pK for pid %d not found",
-                    __func__, streamHandle, pid);
-            return false;
-        }
-        itr++;
+    if (!sr_clbk_dat || sr_clbk_dat->pid_ != pid) {
+        ALOGE("%s: streamHandle: %pK for pid %d not found",
+                __func__, streamHandle, pid);
+        return false;
     }
 
-    ALOGE("%s: client info for pid %d not found",
-            __func__, pid);
-    return false;
+    if (session)
+        *session = sr_clbk_dat;
+    return true;
 }
 
 Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_hidl,
@@ -572,6 +556,7 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
     }
 
     sr_clbk_data->setSessionAttr(attr);
+    sr_clbk_data->prepareTransferBuffers(MetadataParser::WRITE_METADATA_MAX_SIZE());
 
     ret = pal_stream_open(attr, noOfDevices, devices, noOfModifiers, modifiers,
                           callback, (uint64_t)sr_clbk_data.get(), &stream_handle);
@@ -619,6 +604,8 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
         /*stream_open failed, free the callback binder object*/
         sr_clbk_data.clear();
     }
+    if (!ret)
+        addSession((uint64_t)stream_handle, sr_clbk_data);
     _hidl_cb(ret, (uint64_t)stream_handle);
 exit:
     if (modifiers)
@@ -639,6 +626,7 @@ Return<int32_t> PAL::ipc_pal_stream_close(const uint64_t streamHandle)
         return -EINVAL;
     }
 
+    removeSession(streamHandle);
     mClientLock.lock();
     for (auto itr = mPalClients.begin(); itr != mPalClients.end(); ) {
         auto client = *itr;
@@ -649,11 +637,14 @@ Return<int32_t> PAL::ipc_pal_stream_close(const uint64_t streamHandle)
                 for (; sItr != client->mActiveSessions.end(); sItr++) {
                     if (sItr->session_handle == streamHandle) {
                         /*close the shared mem fds dupped in PAL server context*/
-                        for (int i=0; i < sItr->callback_binder->sharedMemFdList.size(); i++) {
-                             close(sItr->callback_binder->sharedMemFdList[i].second);
+                        {
+                            std::lock_guard<std::mutex> fdLock(sItr->callback_binder->mFdListLock);
+                            for (int i=0; i < sItr->callback_binder->sharedMemFdList.size(); i++) {
+                                 close(sItr->callback_binder->sharedMemFdList[i].second);
+                            }
+                            sItr->callback_binder->sharedMemFdList.clear();
                         }
                         ALOGV("Closing the session %pK", streamHandle);
-                        sItr->callback_binder->sharedMemFdList.clear();
                         sItr->callback_binder.clear();
                         break;
                     }
@@ -811,56 +802,43 @@ Return<void> PAL::ipc_pal_stream_get_buffer_size(const uint64_t streamHandle,
 Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
                                           const hidl_vec<PalBuffer>& buff_hidl) {
     struct pal_buffer buf = {0};
+    struct timespec timeStamp;
+    MetadataParser metadataParser;
+    sp<SrvrClbk> sr_clbk_dat;
 
-    if (!isValidstreamHandle(streamHandle)) {
+    if (!isValidstreamHandle(streamHandle, &sr_clbk_dat)) {
         ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
         return -EINVAL;
     }
 
     buf.size = buff_hidl.data()->size;
-    std::vector<uint8_t> dataBuffer;
-    if (buff_hidl.data()->buffer.size() == buf.size) {
-        dataBuffer.resize(buf.size);
-        buf.buffer = dataBuffer.data();
-    }
+    /*
+     * PAL only reads from the write buffer, so hand it the payload
+     * received with the transaction instead of copying it.
+     */
+    if (buff_hidl.data()->buffer.size() == buf.size)
+        buf.buffer = const_cast<uint8_t *>(buff_hidl.data()->buffer.data());
     buf.offset = (size_t)buff_hidl.data()->offset;
-    auto timeStamp = std::make_unique<timespec>();
-    timeStamp->tv_sec =  buff_hidl.data()->timeStamp.tvSec;
-    timeStamp->tv_nsec = buff_hidl.data()->timeStamp.tvNSec;
-    buf.ts = timeStamp.get();
+    timeStamp.tv_sec =  buff_hidl.data()->timeStamp.tvSec;
+    timeStamp.tv_nsec = buff_hidl.data()->timeStamp.tvNSec;
+    buf.ts = &timeStamp;
     buf.flags = buff_hidl.data()->flags;
     buf.frame_index = buff_hidl.data()->frame_index;
 
-    buf.metadata_size = MetadataParser::WRITE_METADATA_MAX_SIZE();
-    std::vector<uint8_t> bufMetadata(buf.metadata_size, 0);
-    buf.metadata = bufMetadata.data();
-    auto stream_media_config = std::make_shared<pal_media_config>();
-    mClientLock.lock();
-    for (auto& s: PAL::getInstance()->mPalClients) {
-        std::lock_guard<std::mutex> lock(s->mActiveSessionsLock);
-        for (auto session : s->mActiveSessions) {
-            if (session.session_handle == streamHandle) {
-                memcpy((uint8_t *)stream_media_config.get(),
-                       (uint8_t *)&session.callback_binder->session_attr.out_media_config,
-                       sizeof(pal_media_config));
-            }
-        }
-    }
-    mClientLock.unlock();
-    auto metadataParser = std::make_unique<MetadataParser>();
-    metadataParser->fillMetaData(buf.metadata, buf.frame_index, buf.size,
-                                 stream_media_config.get());
+    /* fillMetaData rewrites every byte of the start/end metadata items */
+    buf.metadata_size = sr_clbk_dat->mWriteMetadata.size();
+    buf.metadata = sr_clbk_dat->mWriteMetadata.data();
+    metadataParser.fillMetaData(buf.metadata, buf.frame_index, buf.size,
+                                &sr_clbk_dat->session_attr.out_media_config);
     const native_handle *allochandle = buff_hidl.data()->alloc_info.alloc_handle.handle();
 
     buf.alloc_info.alloc_handle = dup(allochandle->data[0]);
-    add_input_and_dup_fd(streamHandle, allochandle->data[1], buf.alloc_info.alloc_handle);
+    add_input_and_dup_fd(sr_clbk_dat, allochandle->data[1], buf.alloc_info.alloc_handle);
 
     ALOGV("%s: fd[input%d - dup%d]", __func__, allochandle->data[1], buf.alloc_info.alloc_handle);
     buf.alloc_info.alloc_size = buff_hidl.data()->alloc_info.alloc_size;
     buf.alloc_info.offset = buff_hidl.data()->alloc_info.offset;
 
-    if (buf.buffer)
-        memcpy(buf.buffer, buff_hidl.data()->buffer.data(), buf.size);
     ALOGV("%s:%d sz %d, frame_index %u", __func__,__LINE__, buf.size, buf.frame_index);
 
     addToPendingInputs(buf.alloc_info.alloc_handle,
@@ -874,21 +852,24 @@ Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
                                       ipc_pal_stream_read_cb _hidl_cb) {
     struct pal_buffer buf = {0};
     hidl_vec<PalBuffer> outBuff_hidl;
+    sp<SrvrClbk> sr_clbk_dat;
 
-    if (!isValidstreamHandle(streamHandle)) {
+    if (!isValidstreamHandle(streamHandle, &sr_clbk_dat)) {
         ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
         return Void();
     }
 
     buf.size = inBuff_hidl.data()->size;
-    std::vector<uint8_t> dataBuffer(buf.size, 0);
-    buf.buffer = dataBuffer.data();
+    if (sr_clbk_dat->mReadData.size() < buf.size)
+        sr_clbk_dat->mReadData.resize(buf.size);
+    std::fill_n(sr_clbk_dat->mReadData.begin(), buf.size, 0);
+    buf.buffer = sr_clbk_dat->mReadData.data();
     buf.metadata_size = MetadataParser::READ_METADATA_MAX_SIZE();
 
     const native_handle *allochandle = inBuff_hidl.data()->alloc_info.alloc_handle.handle();
 
     buf.alloc_info.alloc_handle = dup(allochandle->data[0]);
-    add_input_and_dup_fd(streamHandle, allochandle->data[1], buf.alloc_info.alloc_handle);
+    add_input_and_dup_fd(sr_clbk_dat, allochandle->data[1], buf.alloc_info.alloc_handle);
     ALOGV("%s: fd[input%d - dup%d]", __func__, allochandle->data[1], buf.alloc_info.alloc_handle);
 
     buf.alloc_info.alloc_size = inBuff_hidl.data()->alloc_info.alloc_size;
@@ -896,12 +877,11 @@ Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
 
     int32_t ret = pal_stream_read((pal_stream_handle_t *)streamHandle, &buf);
     if (ret > 0) {
-        outBuff_hidl.resize(sizeof(struct pal_buffer));
+        outBuff_hidl.resize(1);
         outBuff_hidl.data()->size = (uint32_t)buf.size;
         outBuff_hidl.data()->offset = (uint32_t)buf.offset;
-        outBuff_hidl.data()->buffer.resize(buf.size);
-        memcpy(outBuff_hidl.data()->buffer.data(), buf.buffer,
-               buf.size);
+        /* serialized straight from the session buffer inside _hidl_cb */
+        outBuff_hidl.data()->buffer.setToExternal(buf.buffer, buf.size);
         if (buf.ts) {
           outBuff_hidl.data()->timeStamp.tvSec = buf.ts->tv_sec;
           outBuff_hidl.data()->timeStamp.tvNSec = buf.ts->tv_nsec;
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef FRONT_END_POOL_H
+#define FRONT_END_POOL_H
+
+#include <array>
+#include <atomic>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define FE_POOL_WORD_BITS 64
+#define FE_POOL_MAX_IDS 128
+#define FE_POOL_WORDS (FE_POOL_MAX_IDS / FE_POOL_WORD_BITS)
+#define FE_POOL_NO_INDEX 0xffffffffU
+
+struct fe_pool_stats {
+    const char *name;
+    uint32_t capacity;
+    uint32_t inUse;
+    uint32_t peak;
+    uint32_t failures;
+};
+
+/*
+ * Fixed set of front end (or non-tunnel session) ids of one stream class.
+ * Free ids sit on a lock-free LIFO stack, so allocate() hands out the most
+ * recently freed id first, and the last id added when none was freed yet,
+ * like the vector pop_back/push_back it replaced. A set bit in freeMask_
+ * marks a free id and catches double frees and leaks. Ids are added with
+ * addId() while the resource manager is being set up and stay fixed until
+ * reset().
+ */
+class FrontEndPool {
+public:
+    FrontEndPool(const char *name);
+    ~FrontEndPool() {};
+    int addId(int id);
+    void reset();
+    int allocate();
+    int release(int id);
+    size_t capacity() const { return count_; }
+    int getId(size_t index) const { return index < count_ ? ids_[index] : -EINVAL; }
+    void getStats(struct fe_pool_stats *stats) const;
+    uint32_t checkLeaks() const;
+
+private:
+    void push(uint32_t index);
+    uint32_t pop();
+
+    const char *name_;
+    /* top of the free stack in the low 32 bits, ABA tag in the high ones */
+    std::atomic<uint64_t> freeHead_;
+    std::array<std::atomic<uint32_t>, FE_POOL_MAX_IDS> freeNext_;
+    std::array<std::atomic<uint64_t>, FE_POOL_WORDS> freeMask_;
+    std::array<int, FE_POOL_MAX_IDS> ids_;
+    std::vector<int16_t> indexOf_;
+    size_t count_;
+    std::atomic<uint32_t> inUse_;
+    std::atomic<uint32_t> peak_;
+    std::atomic<uint32_t> failures_;
+};
+
+#endif // FRONT_END_POOL_H
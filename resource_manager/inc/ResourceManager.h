@@ -39,6 +39,9 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
 #include <string>
 #include "audio_route/audio_route.h"
 #include <tinyalsa/asoundlib.h>
@@ -55,6 +58,7 @@
 #include "PalDefs.h"
 #include "ChargerListener.h"
 #include "SndCardMonitor.h"
+#include "FrontEndPool.h"
 #include "ContextManager.h"
 #include "SoundTriggerPlatformInfo.h"
 #include "SignalHandler.h"
@@ -86,7 +90,13 @@ typedef enum {
 #define AUDIO_PARAMETER_KEY_SPKR_XMAX_TMAX_LOG "spkr_xmax_tmax_logging_enable"
 #define MAX_PCM_NAME_SIZE 50
 #define MAX_STREAM_INSTANCES (sizeof(uint64_t) << 3)
+/* pal_stream_handle_t value = (generation << STREAM_HANDLE_SLOT_BITS) | slot */
+#define STREAM_HANDLE_SLOT_BITS 8
+#define MAX_STREAM_HANDLES (1 << STREAM_HANDLE_SLOT_BITS)
+#define STREAM_HANDLE_GEN_MASK 0xFFFFFF
 #define MIN_USECASE_PRIORITY 0xFFFFFFFF
+/* buckets of the active stream index, see activeStreamSlot() */
+#define ACTIVE_STREAM_SLOT_MAX 18
 #if LINUX_ENABLED
 #if defined(__LP64__)
 #define ADM_LIBRARY_PATH "/usr/lib64/libadm.so"
@@ -361,6 +371,38 @@ enum NTStreamTypes_t : uint32_t {
 
 typedef void (*session_callback)(uint64_t hdl, uint32_t event_id, void *event_data,
                 uint32_t event_size, uint32_t miid);
+
+#define MIXER_EVENT_LATENCY_BUCKETS PAL_MIXER_EVENT_LATENCY_BUCKETS
+
+/*
+ * Dispatch thread of one subscriber class, i.e. one session callback.
+ * Events of a class run in order on their own thread, so a callback that
+ * blocks only delays its own class.
+ */
+struct mixer_event_worker {
+    session_callback cb;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> queue;
+    bool exit;
+};
+
+/*
+ * Mixer event subscription of one pcm id. The event control and its size
+ * are resolved at registration; callbacks run on the worker of the
+ * subscriber's callback.
+ */
+struct mixer_event_binding {
+    session_callback cb;
+    uint64_t cookie;
+    std::shared_ptr<mixer_event_worker> worker;
+    std::atomic<bool> revoked;
+    struct mixer_ctl *ctl;
+    unsigned int numValues;
+    std::mutex bufMutex;
+    std::vector<std::vector<uint8_t>> spareBufs;
+};
 bool isPalPCMFormat(uint32_t fmt_id);
 
 typedef void* (*adm_init_t)();
@@ -426,6 +468,16 @@ struct deviceIn {
     bool ec_enable;
 };
 
+struct stream_handle_slot {
+    std::atomic<uint32_t> generation;
+    std::atomic<Stream *> stream;
+};
+
+struct active_stream_entry {
+    Stream *s;
+    pal_stream_type_t type;
+};
+
 class ResourceManager
 {
 
@@ -434,6 +486,7 @@ private:
     int mPriorityHighestPriorityActiveStream; //priority of the highest priority active stream
     Stream* mHighestPriorityActiveStream; //pointer to the highest priority active stream
     int getNumFEs(const pal_stream_type_t sType) const;
+    static int activeStreamSlot(pal_stream_type_t type);
     bool ifVoiceorVoipCall (pal_stream_type_t streamType) const;
     int getCallPriority(bool ifVoiceCall) const;
     int getStreamAttrPriority (const pal_stream_attributes* sAttr) const;
@@ -442,8 +495,8 @@ private:
     void getHigherPriorityActiveStreams(const int inComingStreamPriority,
                                         std::vector<Stream*> &activestreams,
                                         std::vector<T> sourcestreams);
-    const std::vector<int> allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds,
-                                  const int howMany);
+    const std::vector<int> allocateVoiceFrontEndIds(const FrontEndPool &pool, const int howMany);
+    static FrontEndPool *getFrontEndPool(const struct pal_stream_attributes &sAttr, int lDirection);
     int getDeviceDefaultCapability(pal_param_device_capability_t capability);
 
     int handleScreenStatusChange(pal_param_screen_state_t screen_state);
@@ -455,6 +508,11 @@ private:
     int32_t streamDevDisconnect_l(std::vector <std::tuple<Stream *, uint32_t>> streamDevDisconnectList);
     int32_t streamDevConnect_l(std::vector <std::tuple<Stream *, struct pal_device *>> streamDevConnectList);
     void ssrHandlingLoop(std::shared_ptr<ResourceManager> rm);
+    std::string getSsrChainKey(int devId);
+    void getSsrUpChains(const std::vector<Stream*> &streams,
+                        std::vector<std::vector<Stream*>> &chains);
+    void ssrUpChain(const std::vector<Stream*> &chain);
+    void ssrUpChains(const std::vector<std::vector<Stream*>> &chains);
     int updateECDeviceMap(std::shared_ptr<Device> rx_dev,
                         std::shared_ptr<Device> tx_dev,
                         Stream *tx_str, int count, bool is_txstop);
@@ -492,10 +550,23 @@ protected:
     std::list <StreamUltraSound*> active_streams_ultrasound;
     std::list <StreamSensorPCMData*> active_streams_sensor_pcm_data;
     std::list <StreamContextProxy*> active_streams_context_proxy;
+    /*
+     * Type-erased view of the active_streams_* lists, one bucket per list
+     * in getActiveStream_l() merge order, updated with them under
+     * mActiveStreamMutex.
+     */
+    std::array<std::vector<active_stream_entry>, ACTIVE_STREAM_SLOT_MAX> mActiveStreamSlots;
     std::vector <std::pair<std::shared_ptr<Device>, Stream*>> active_devices;
     std::vector <std::shared_ptr<Device>> plugin_devices_;
     std::vector <pal_device_id_t> avail_devices_;
     std::map<Stream*, std::pair<uint32_t, bool>> mActiveStreamUserCounter;
+    /*
+     * handles given out by pal_stream_open index this table directly.
+     * Slot allocation and release are done with mActiveStreamMutex held,
+     * lookups only use atomics so they can be done without any lock.
+     */
+    std::array<stream_handle_slot, MAX_STREAM_HANDLES> mStreamHandleTable;
+    std::vector<uint32_t> mFreeStreamHandleSlots;
     bool bOverwriteFlag;
     bool screen_state_ = true;
     bool charging_state_;
@@ -510,7 +581,6 @@ protected:
     static std::mutex mGraphMutex;
     static std::mutex mActiveStreamMutex;
     static std::mutex mSleepMonitorMutex;
-    static std::mutex mListFrontEndsMutex;
     static int snd_virt_card;
     static int snd_hw_card;
 
@@ -526,25 +596,28 @@ protected:
     static std::vector<std::pair<int32_t, int32_t>> devicePcmId;
     static std::vector<std::pair<int32_t, std::string>> deviceLinkName;
     static std::vector<int> listAllFrontEndIds;
-    static std::vector<int> listAllPcmPlaybackFrontEnds;
-    static std::vector<int> listAllPcmRecordFrontEnds;
-    static std::vector<int> listAllPcmHostlessRxFrontEnds;
-    static std::vector<int> listAllNonTunnelSessionIds;
-    static std::vector<int> listAllPcmHostlessTxFrontEnds;
-    static std::vector<int> listAllCompressPlaybackFrontEnds;
-    static std::vector<int> listAllCompressRecordFrontEnds;
+    static FrontEndPool pcmPlaybackFrontEnds;
+    static FrontEndPool pcmRecordFrontEnds;
+    static FrontEndPool pcmHostlessRxFrontEnds;
+    static FrontEndPool nonTunnelSessionIds;
+    static FrontEndPool pcmHostlessTxFrontEnds;
+    static FrontEndPool compressPlaybackFrontEnds;
+    static FrontEndPool compressRecordFrontEnds;
     static std::vector<int> listFreeFrontEndIds;
-    static std::vector<int> listAllPcmVoice1RxFrontEnds;
-    static std::vector<int> listAllPcmVoice1TxFrontEnds;
-    static std::vector<int> listAllPcmVoice2RxFrontEnds;
-    static std::vector<int> listAllPcmVoice2TxFrontEnds;
-    static std::vector<int> listAllPcmExtEcTxFrontEnds;
-    static std::vector<int> listAllPcmInCallRecordFrontEnds;
-    static std::vector<int> listAllPcmInCallMusicFrontEnds;
-    static std::vector<int> listAllPcmContextProxyFrontEnds;
+    static FrontEndPool pcmVoice1RxFrontEnds;
+    static FrontEndPool pcmVoice1TxFrontEnds;
+    static FrontEndPool pcmVoice2RxFrontEnds;
+    static FrontEndPool pcmVoice2TxFrontEnds;
+    static FrontEndPool pcmExtEcTxFrontEnds;
+    static FrontEndPool pcmInCallRecordFrontEnds;
+    static FrontEndPool pcmInCallMusicFrontEnds;
+    static FrontEndPool pcmContextProxyFrontEnds;
+    static FrontEndPool *const frontEndPools[];
     static std::vector<std::pair<int32_t, std::string>> listAllBackEndIds;
     static std::vector<std::pair<int32_t, std::string>> sndDeviceNameLUT;
     static std::vector<deviceCap> devInfo;
+    /* devInfo position by PCM/compress device id, -1 when not in the xml */
+    static std::vector<int16_t> devInfoIndex;
     static std::map<std::pair<uint32_t, std::string>, std::string> btCodecMap;
     static std::map<std::string, uint32_t> btFmtTable;
     static std::map<std::string, int> spkrPosTable;
@@ -552,6 +625,8 @@ protected:
     static std::map<uint32_t, uint32_t> btSlimClockSrcMap;
     static std::vector<deviceIn> deviceInfo;
     static std::vector<tx_ecinfo> txEcInfo;
+    /* per tx stream type, bit n set when EC ref is disabled for rx stream type n */
+    static std::array<uint64_t, PAL_STREAM_MAX> ecRefDisabledRxMask;
     static struct vsid_info vsidInfo;
     static struct volume_set_param_info volumeSetParamInfo_;
     static struct disable_lpm_info disableLpmInfo_;
@@ -578,7 +653,14 @@ protected:
     static int wake_unlock_fd;
     static uint32_t wake_lock_cnt;
     static bool lpi_logging_;
-    std::map<int, std::pair<session_callback, uint64_t>> mixerEventCallbackMap;
+    /* indexed by pcm id */
+    std::vector<std::shared_ptr<mixer_event_binding>> mixerEventTable;
+    /* one per callback, created on first registration, joined in deinit() */
+    std::vector<std::shared_ptr<mixer_event_worker>> mixerEventWorkers;
+    std::mutex mixerEventMutex;
+    std::shared_ptr<mixer_event_worker> getMixerEventWorker_l(session_callback cb);
+    void stopMixerEventWorkers();
+    static std::atomic<uint64_t> mixerEventLatencyHist[MIXER_EVENT_LATENCY_BUCKETS];
     static std::thread mixerEventTread;
     std::shared_ptr<CaptureProfile> SoundTriggerCaptureProfile;
     ResourceManager();
@@ -628,6 +710,8 @@ public:
     static bool isMainSpeakerRight;
     /* Variable to store Quick calibration time for Speaker protection */
     static int spQuickCalTime;
+    /* Interval of Xmax/Tmax telemetry sampling in ms, 0 for default */
+    static int spXmaxTmaxLogInterval;
     /* Variable to store the mode request for Speaker protection */
     pal_spkr_prot_payload mSpkrProtModeValue;
 
@@ -713,6 +797,9 @@ public:
     int registerStream(Stream *s);
     int deregisterStream(Stream *s);
     int isActiveStream(pal_stream_handle_t *handle);
+    pal_stream_handle_t* allocStreamHandle(Stream *s);
+    void freeStreamHandle_l(Stream *s);
+    Stream* getStreamFromHandle(pal_stream_handle_t *handle);
     int initStreamUserCounter(Stream *s);
     int deactivateStreamUserCounter(Stream *s);
     int eraseStreamUserCounter(Stream *s);
@@ -783,6 +870,7 @@ public:
     int getHwAudioMixer(struct audio_mixer **am);
     int getActiveStream(std::vector<Stream*> &activestreams, std::shared_ptr<Device> d = nullptr);
     int getActiveStream_l(std::vector<Stream*> &activestreams,std::shared_ptr<Device> d = nullptr);
+    int getActiveStreamsOfType_l(pal_stream_type_t type, std::vector<Stream*> &activestreams);
     int getOrphanStream(std::vector<Stream*> &orphanstreams, std::vector<Stream*> &retrystreams);
     int getOrphanStream_l(std::vector<Stream*> &orphanstreams, std::vector<Stream*> &retrystreams);
     void getActiveDevices(std::vector<std::shared_ptr<Device>> &deviceList);
@@ -803,6 +891,8 @@ public:
                                                 int lDirection);
     const std::vector<int> allocateFrontEndExtEcIds ();
     void freeFrontEndEcTxIds (const std::vector<int> f);
+    void getFrontEndPoolStats(std::vector<struct fe_pool_stats> &stats);
+    uint32_t checkFrontEndLeaks();
     void freeFrontEndIds (const std::vector<int> f,
                           const struct pal_stream_attributes,
                           int lDirection);
@@ -860,6 +950,7 @@ public:
     static void mixerEventWaitThreadLoop(std::shared_ptr<ResourceManager> rm);
     bool isCallbackRegistered() { return (mixerEventRegisterCount > 0); }
     int handleMixerEvent(struct mixer *mixer, char *mixer_str);
+    static void getMixerEventLatencyStats(uint64_t *hist, size_t count);
     int StopOtherDetectionStreams(void *st);
     int StartOtherDetectionStreams(void *st);
     void GetConcurrencyInfo(pal_stream_type_t st_type,
@@ -967,7 +1058,10 @@ public:
                                      pal_device *newDevAttr, bool enable);
     int32_t streamDevSwitch(std::vector <std::tuple<Stream *, uint32_t>> streamDevDisconnectList,
                             std::vector <std::tuple<Stream *, struct pal_device *>> streamDevConnectList);
-    char* getDeviceNameFromID(uint32_t id);
+    char* getDeviceNameFromID(uint32_t id) {
+        return (id < devInfoIndex.size() && devInfoIndex[id] >= 0) ?
+               devInfo[devInfoIndex[id]].name : NULL;
+    }
     int getPalValueFromGKV(pal_key_vector_t *gkv, int key);
     pal_speaker_rotation_type getCurrentRotationType();
     void ssrHandler(card_status_t state);
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#define LOG_TAG "PAL: FrontEndPool"
+
+#include "FrontEndPool.h"
+#include "PalCommon.h"
+
+FrontEndPool::FrontEndPool(const char *name)
+    : name_(name),
+      freeHead_(FE_POOL_NO_INDEX),
+      count_(0),
+      inUse_(0),
+      peak_(0),
+      failures_(0)
+{
+    for (auto &word : freeMask_)
+        word.store(0);
+}
+
+int FrontEndPool::addId(int id)
+{
+    if (id < 0 || count_ >= FE_POOL_MAX_IDS) {
+        PAL_ERR(LOG_TAG, "%s: cannot add id %d, %zu ids in pool", name_, id, count_);
+        return -EINVAL;
+    }
+    if ((size_t)id < indexOf_.size() && indexOf_[id] >= 0) {
+        PAL_ERR(LOG_TAG, "%s: id %d added twice", name_, id);
+        return -EINVAL;
+    }
+    if ((size_t)id >= indexOf_.size())
+        indexOf_.resize(id + 1, -1);
+
+    indexOf_[id] = count_;
+    ids_[count_] = id;
+    freeMask_[count_ / FE_POOL_WORD_BITS].fetch_or(1ULL << (count_ % FE_POOL_WORD_BITS));
+    push(count_);
+    count_++;
+    return 0;
+}
+
+void FrontEndPool::reset()
+{
+    freeHead_.store(FE_POOL_NO_INDEX);
+    for (auto &word : freeMask_)
+        word.store(0);
+    indexOf_.clear();
+    count_ = 0;
+    inUse_.store(0);
+    peak_.store(0);
+    failures_.store(0);
+}
+
+/*
+ * The tag in the high half of freeHead_ changes on every push and pop, so
+ * a pop that read a stale next index fails its CAS instead of corrupting
+ * the stack when the same index was popped and pushed back meanwhile.
+ */
+void FrontEndPool::push(uint32_t index)
+{
+    uint64_t head = freeHead_.load();
+    uint64_t next = 0;
+
+    do {
+        freeNext_[index].store((uint32_t)head, std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (!freeHead_.compare_exchange_weak(head, next));
+}
+
+uint32_t FrontEndPool::pop()
+{
+    uint64_t head = freeHead_.load();
+    uint64_t next = 0;
+    uint32_t index = 0;
+
+    do {
+        index = (uint32_t)head;
+        if (index == FE_POOL_NO_INDEX)
+            return FE_POOL_NO_INDEX;
+        next = (((head >> 32) + 1) << 32) |
+               freeNext_[index].load(std::memory_order_relaxed);
+    } while (!freeHead_.compare_exchange_weak(head, next));
+
+    return index;
+}
+
+/* Hands out the most recently freed id, as the old free list did */
+int FrontEndPool::allocate()
+{
+    uint32_t index = pop();
+    uint32_t inUse = 0;
+    uint32_t peak = 0;
+
+    if (index == FE_POOL_NO_INDEX) {
+        failures_.fetch_add(1);
+        PAL_ERR(LOG_TAG, "%s: all %zu ids in use, peak %u, failures %u", name_,
+                count_, peak_.load(), failures_.load());
+        return -ENOSPC;
+    }
+
+    freeMask_[index / FE_POOL_WORD_BITS].fetch_and(~(1ULL << (index % FE_POOL_WORD_BITS)));
+    inUse = inUse_.fetch_add(1) + 1;
+    peak = peak_.load();
+    while (inUse > peak && !peak_.compare_exchange_weak(peak, inUse));
+    return ids_[index];
+}
+
+int FrontEndPool::release(int id)
+{
+    int index = 0;
+    uint64_t mask = 0;
+
+    if (id < 0 || (size_t)id >= indexOf_.size() || indexOf_[id] < 0) {
+        PAL_ERR(LOG_TAG, "%s: id %d does not belong to pool", name_, id);
+        return -EINVAL;
+    }
+
+    index = indexOf_[id];
+    mask = 1ULL << (index % FE_POOL_WORD_BITS);
+    if (freeMask_[index / FE_POOL_WORD_BITS].fetch_or(mask) & mask) {
+        PAL_ERR(LOG_TAG, "%s: id %d freed twice", name_, id);
+        return -EALREADY;
+    }
+    inUse_.fetch_sub(1);
+    push(index);
+    return 0;
+}
+
+void FrontEndPool::getStats(struct fe_pool_stats *stats) const
+{
+    if (!stats)
+        return;
+
+    stats->name = name_;
+    stats->capacity = count_;
+    stats->inUse = inUse_.load();
+    stats->peak = peak_.load();
+    stats->failures = failures_.load();
+}
+
+/* Logs every id still allocated and returns how many there are */
+uint32_t FrontEndPool::checkLeaks() const
+{
+    uint32_t leaked = 0;
+
+    for (size_t i = 0; i < count_; i++) {
+        if (freeMask_[i / FE_POOL_WORD_BITS].load() & (1ULL << (i % FE_POOL_WORD_BITS)))
+            continue;
+        PAL_ERR(LOG_TAG, "%s: id %d was never freed", name_, ids_[i]);
+        leaked++;
+    }
+
+    return leaked;
+}
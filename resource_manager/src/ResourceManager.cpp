@@ -62,11 +62,13 @@
 #include "SndCardMonitor.h"
 #include "UltrasoundDevice.h"
 #include "ECRefDevice.h"
+#include "SessionAlsaUtils.h"
 #include <agm/agm_api.h>
 #include <cutils/properties.h>
 #include <unistd.h>
 #include <dlfcn.h>
 #include <mutex>
+#include <chrono>
 #include "kvh2xml.h"
 #include <sys/ioctl.h>
 
@@ -115,6 +117,10 @@
                                   // actual will be updated during init_audio
 
 #define DEFAULT_BIT_WIDTH 16
+#define SSR_UP_MAX_WORKERS 4
+#define SSR_CHAIN_KEY_VA "#va"
+#define SSR_CHAIN_KEY_NO_DEVICE "#no-device"
+#define MIXER_EVENT_SPARE_BUFS 4
 #define DEFAULT_SAMPLE_RATE 48000
 #define DEFAULT_CHANNELS 2
 #define DEFAULT_FORMAT 0x00000000u
@@ -430,30 +436,37 @@ std::mutex ResourceManager::mChargerBoostMutex;
 std::mutex ResourceManager::mGraphMutex;
 std::mutex ResourceManager::mActiveStreamMutex;
 std::mutex ResourceManager::mSleepMonitorMutex;
-std::mutex ResourceManager::mListFrontEndsMutex;
 std::vector <int> ResourceManager::listAllFrontEndIds = {0};
 std::vector <int> ResourceManager::listFreeFrontEndIds = {0};
-std::vector <int> ResourceManager::listAllPcmPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessRxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmExtEcTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallMusicFrontEnds = {0};
-std::vector <int> ResourceManager::listAllNonTunnelSessionIds = {0};
-std::vector <int> ResourceManager::listAllPcmContextProxyFrontEnds = {0};
+FrontEndPool ResourceManager::pcmPlaybackFrontEnds("pcm-playback");
+FrontEndPool ResourceManager::pcmRecordFrontEnds("pcm-record");
+FrontEndPool ResourceManager::pcmHostlessRxFrontEnds("pcm-hostless-rx");
+FrontEndPool ResourceManager::pcmHostlessTxFrontEnds("pcm-hostless-tx");
+FrontEndPool ResourceManager::pcmExtEcTxFrontEnds("pcm-ext-ec-tx");
+FrontEndPool ResourceManager::compressPlaybackFrontEnds("compress-playback");
+FrontEndPool ResourceManager::compressRecordFrontEnds("compress-record");
+FrontEndPool ResourceManager::pcmVoice1RxFrontEnds("pcm-voice1-rx");
+FrontEndPool ResourceManager::pcmVoice1TxFrontEnds("pcm-voice1-tx");
+FrontEndPool ResourceManager::pcmVoice2RxFrontEnds("pcm-voice2-rx");
+FrontEndPool ResourceManager::pcmVoice2TxFrontEnds("pcm-voice2-tx");
+FrontEndPool ResourceManager::pcmInCallRecordFrontEnds("pcm-incall-record");
+FrontEndPool ResourceManager::pcmInCallMusicFrontEnds("pcm-incall-music");
+FrontEndPool ResourceManager::nonTunnelSessionIds("non-tunnel");
+FrontEndPool ResourceManager::pcmContextProxyFrontEnds("pcm-context-proxy");
+FrontEndPool *const ResourceManager::frontEndPools[] = {
+    &pcmPlaybackFrontEnds, &pcmRecordFrontEnds, &pcmHostlessRxFrontEnds,
+    &pcmHostlessTxFrontEnds, &pcmExtEcTxFrontEnds, &compressPlaybackFrontEnds,
+    &compressRecordFrontEnds, &pcmVoice1RxFrontEnds, &pcmVoice1TxFrontEnds,
+    &pcmVoice2RxFrontEnds, &pcmVoice2TxFrontEnds, &pcmInCallRecordFrontEnds,
+    &pcmInCallMusicFrontEnds, &nonTunnelSessionIds, &pcmContextProxyFrontEnds,
+};
 struct audio_mixer* ResourceManager::audio_virt_mixer = NULL;
 struct audio_mixer* ResourceManager::audio_hw_mixer = NULL;
 struct audio_route* ResourceManager::audio_route = NULL;
 int ResourceManager::snd_virt_card = SND_CARD_VIRTUAL;
 int ResourceManager::snd_hw_card = SND_CARD_HW;
 std::vector<deviceCap> ResourceManager::devInfo;
+std::vector<int16_t> ResourceManager::devInfoIndex;
 static struct nativeAudioProp na_props;
 static bool isHifiFilterEnabled = false;
 SndCardMonitor* ResourceManager::sndmon = NULL;
@@ -473,6 +486,7 @@ std::thread ResourceManager::workerThread;
 std::thread ResourceManager::mixerEventTread;
 bool ResourceManager::mixerClosed = false;
 int ResourceManager::mixerEventRegisterCount = 0;
+std::atomic<uint64_t> ResourceManager::mixerEventLatencyHist[MIXER_EVENT_LATENCY_BUCKETS];
 int ResourceManager::concurrencyEnableCount = 0;
 int ResourceManager::concurrencyDisableCount = 0;
 int ResourceManager::ACDConcurrencyEnableCount = 0;
@@ -501,6 +515,7 @@ static int max_nt_sessions;
 bool ResourceManager::isRasEnabled = false;
 bool ResourceManager::isMainSpeakerRight;
 int ResourceManager::spQuickCalTime;
+int ResourceManager::spXmaxTmaxLogInterval = 0;
 bool ResourceManager::isGaplessEnabled = false;
 bool ResourceManager::isDualMonoEnabled = false;
 bool ResourceManager::isUHQAEnabled = false;
@@ -542,6 +557,7 @@ void str_parms_destroy(struct str_parms *str_parms){return;}
 std::vector<vote_type_t> ResourceManager::sleep_monitor_vote_type_(PAL_STREAM_MAX, NLPI_VOTE);
 std::vector<deviceIn> ResourceManager::deviceInfo;
 std::vector<tx_ecinfo> ResourceManager::txEcInfo;
+std::array<uint64_t, PAL_STREAM_MAX> ResourceManager::ecRefDisabledRxMask = {};
 struct vsid_info ResourceManager::vsidInfo;
 struct volume_set_param_info ResourceManager::volumeSetParamInfo_;
 struct disable_lpm_info ResourceManager::disableLpmInfo_;
@@ -815,6 +831,13 @@ ResourceManager::ResourceManager()
     mHighestPriorityActiveStream = nullptr;
     mPriorityHighestPriorityActiveStream = 0;
 
+    /* slots are handed out from the back, keep low indexes first */
+    for (int i = MAX_STREAM_HANDLES - 1; i >= 0; i--) {
+        mStreamHandleTable[i].generation.store(1, std::memory_order_relaxed);
+        mStreamHandleTable[i].stream.store(nullptr, std::memory_order_relaxed);
+        mFreeStreamHandleSlots.push_back(i);
+    }
+
     ret = ResourceManager::XmlParser(SNDPARSER);
     if (ret) {
         PAL_ERR(LOG_TAG, "error in snd xml parsing ret %d", ret);
@@ -872,21 +895,8 @@ ResourceManager::ResourceManager()
 #endif
     listAllFrontEndIds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllPcmInCallRecordFrontEnds.clear();
-    listAllPcmInCallMusicFrontEnds.clear();
-    listAllPcmContextProxyFrontEnds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
+    for (auto pool : frontEndPools)
+        pool->reset();
     memset(stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
     memset(in_stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
 
@@ -894,43 +904,43 @@ ResourceManager::ResourceManager()
 
         if (devInfo[i].type == PCM) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmHostlessRxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmHostlessRxFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmHostlessTxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmHostlessTxFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].playback == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                pcmPlaybackFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmRecordFrontEnds.push_back(devInfo[i].deviceId);
+                pcmRecordFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].record == 1) {
-                listAllPcmInCallRecordFrontEnds.push_back(devInfo[i].deviceId);
+                pcmInCallRecordFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].playback == 1) {
-                listAllPcmInCallMusicFrontEnds.push_back(devInfo[i].deviceId);
+                pcmInCallMusicFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NO_CONFIG && devInfo[i].record == 1) {
-                listAllPcmContextProxyFrontEnds.push_back(devInfo[i].deviceId);
+                pcmContextProxyFrontEnds.addId(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == COMPRESS) {
             if (devInfo[i].playback == 1) {
-                listAllCompressPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                compressPlaybackFrontEnds.addId(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1) {
-                listAllCompressRecordFrontEnds.push_back(devInfo[i].deviceId);
+                compressRecordFrontEnds.addId(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE1) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice1RxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice1RxFrontEnds.addId(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice1TxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice1TxFrontEnds.addId(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE2) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice2RxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice2RxFrontEnds.addId(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice2TxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice2TxFrontEnds.addId(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == ExtEC) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmExtEcTxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmExtEcTxFrontEnds.addId(devInfo[i].deviceId);
             }
         }
         /*We create a master list of all the frontends*/
@@ -945,7 +955,7 @@ ResourceManager::ResourceManager()
      sort(listAllFrontEndIds.rbegin(), listAllFrontEndIds.rend());
      int maxDeviceIdInUse = listAllFrontEndIds.at(0);
      for (int i = 0; i < max_nt_sessions; i++)
-          listAllNonTunnelSessionIds.push_back(maxDeviceIdInUse + i);
+          nonTunnelSessionIds.addId(maxDeviceIdInUse + i);
 
     // Get AGM service handle
     ret = agm_register_service_crash_callback(&agmServiceCrashHandler,
@@ -992,23 +1002,16 @@ ResourceManager::~ResourceManager()
     devicePpTag.clear();
     deviceTag.clear();
 
+    checkFrontEndLeaks();
+    for (auto pool : frontEndPools)
+        pool->reset();
     listAllFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
     devInfo.clear();
+    devInfoIndex.clear();
     deviceInfo.clear();
     txEcInfo.clear();
+    ecRefDisabledRxMask.fill(0);
 
     STInstancesLists.clear();
     listAllBackEndIds.clear();
@@ -1265,6 +1268,9 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
             mActiveStreamMutex.lock();
             rm->cardState = state;
             if (state != prevState) {
+                /* controls are re-enumerated when the card comes back */
+                SessionAlsaUtils::invalidateMixerCtlCache();
+                SessionAlsaUtils::invalidateMiidCache();
                 if (rm->globalCb) {
                     PAL_DBG(LOG_TAG, "Notifying client about sound card state %d global cb %pK",
                                       rm->cardState, rm->globalCb);
@@ -1338,21 +1344,15 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
                 }
 
                 SoundTriggerCaptureProfile = GetCaptureProfileByPriority(nullptr);
-                for (auto str: rm->mActiveStreams) {
-                    ret = increaseStreamUserCounter(str);
-                    if (0 != ret) {
-                        PAL_ERR(LOG_TAG, "Error incrementing the stream counter for the stream handle: %pK", str);
-                        continue;
-                    }
-                    ret = str->ssrUpHandler();
-                    if (0 != ret) {
-                        PAL_ERR(LOG_TAG, "Ssr up handling failed for %pK ret %d",
-                                          str, ret);
-                    }
-                    ret = decreaseStreamUserCounter(str);
-                    if (0 != ret) {
-                        PAL_ERR(LOG_TAG, "Error decrementing the stream counter for the stream handle: %pK", str);
-                    }
+                {
+                    std::vector<Stream*> streams(rm->mActiveStreams.begin(),
+                                                 rm->mActiveStreams.end());
+                    std::vector<std::vector<Stream*>> chains;
+
+                    getSsrUpChains(streams, chains);
+                    mActiveStreamMutex.unlock();
+                    ssrUpChains(chains);
+                    mActiveStreamMutex.lock();
                 }
                 prevState = state;
             } else {
@@ -1365,6 +1365,152 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
     PAL_INFO(LOG_TAG, "ssr Handling thread ended");
 }
 
+/* Chain key of a device: its backend, or the id if it has no backend */
+std::string ResourceManager::getSsrChainKey(int devId)
+{
+    std::string backEndName;
+
+    if (getBackendName(devId, backEndName) == 0 && !backEndName.empty())
+        return backEndName;
+    return "#dev-" + std::to_string(devId);
+}
+
+/*
+ * Split the streams to restore after SSR into chains that do not depend on
+ * each other. Streams sharing a backend, a possible EC reference path
+ * (tx backend and the backends of the rx devices it may take EC from) or
+ * the VA capture profile are joined into one chain and keep their list
+ * order. Devices are keyed by backend because distinct device ids can share
+ * one hw interface. Streams with no devices cannot be classified and share
+ * a single chain.
+ */
+void ResourceManager::getSsrUpChains(const std::vector<Stream*> &streams,
+                                     std::vector<std::vector<Stream*>> &chains)
+{
+    std::map<std::string, std::string> parent;
+    std::map<std::string, size_t> chainIdx;
+    std::vector<std::vector<std::string>> streamKeys(streams.size());
+    std::vector<std::shared_ptr<Device>> devices;
+    pal_stream_type_t type;
+    int devId = 0;
+
+    auto findRoot = [&parent](std::string key) {
+        while (parent[key] != key) {
+            parent[key] = parent[parent[key]];
+            key = parent[key];
+        }
+        return key;
+    };
+
+    for (size_t i = 0; i < streams.size(); i++) {
+        std::vector<std::string> &keys = streamKeys[i];
+
+        devices.clear();
+        streams[i]->getAssociatedDevices(devices);
+        for (auto &dev : devices) {
+            devId = dev->getSndDeviceId();
+            keys.push_back(getSsrChainKey(devId));
+            for (auto &info : deviceInfo) {
+                if (info.deviceId != devId)
+                    continue;
+                for (auto rxDevId : info.rx_dev_ids)
+                    keys.push_back(getSsrChainKey(rxDevId));
+            }
+        }
+        if (streams[i]->getStreamType(&type) == 0 &&
+            (type == PAL_STREAM_VOICE_UI || type == PAL_STREAM_ACD ||
+             type == PAL_STREAM_SENSOR_PCM_DATA ||
+             type == PAL_STREAM_CONTEXT_PROXY ||
+             type == PAL_STREAM_ULTRASOUND))
+            keys.push_back(SSR_CHAIN_KEY_VA);
+        if (keys.empty())
+            keys.push_back(SSR_CHAIN_KEY_NO_DEVICE);
+
+        for (auto key : keys) {
+            if (parent.find(key) == parent.end())
+                parent[key] = key;
+            parent[findRoot(key)] = findRoot(keys[0]);
+        }
+    }
+
+    for (size_t i = 0; i < streams.size(); i++) {
+        std::string root = findRoot(streamKeys[i][0]);
+
+        if (chainIdx.find(root) == chainIdx.end()) {
+            chainIdx[root] = chains.size();
+            chains.emplace_back();
+        }
+        chains[chainIdx[root]].push_back(streams[i]);
+    }
+    PAL_INFO(LOG_TAG, "%zu streams in %zu ssr up chains", streams.size(), chains.size());
+}
+
+/*
+ * Restore one chain in order. ssrUpHandler expects mActiveStreamMutex held
+ * and drops it around the blocking start, which is where chains overlap.
+ */
+void ResourceManager::ssrUpChain(const std::vector<Stream*> &chain)
+{
+    int32_t ret = 0;
+
+    for (auto str : chain) {
+        auto begin = std::chrono::steady_clock::now();
+
+        mActiveStreamMutex.lock();
+        ret = increaseStreamUserCounter(str);
+        if (0 != ret) {
+            PAL_ERR(LOG_TAG, "Error incrementing the stream counter for the stream handle: %pK", str);
+            mActiveStreamMutex.unlock();
+            continue;
+        }
+        ret = str->ssrUpHandler();
+        if (0 != ret) {
+            PAL_ERR(LOG_TAG, "Ssr up handling failed for %pK ret %d",
+                              str, ret);
+        }
+        ret = decreaseStreamUserCounter(str);
+        if (0 != ret) {
+            PAL_ERR(LOG_TAG, "Error decrementing the stream counter for the stream handle: %pK", str);
+        }
+        mActiveStreamMutex.unlock();
+
+        PAL_INFO(LOG_TAG, "Ssr up for %pK took %lld ms", str,
+                 (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - begin).count());
+    }
+}
+
+/*
+ * Called without mActiveStreamMutex; returns once every chain is restored.
+ * The SSR thread works alongside up to SSR_UP_MAX_WORKERS - 1 dedicated
+ * threads. Stream restore blocks on the DSP, so it stays off the shared
+ * executor, whose busy workers could otherwise hold the SSR thread up.
+ */
+void ResourceManager::ssrUpChains(const std::vector<std::vector<Stream*>> &chains)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    size_t numWorkers = std::min(chains.size(), (size_t)SSR_UP_MAX_WORKERS);
+    auto begin = std::chrono::steady_clock::now();
+    auto work = [&]() {
+        size_t i;
+
+        while ((i = next++) < chains.size())
+            ssrUpChain(chains[i]);
+    };
+
+    for (size_t i = 1; i < numWorkers; i++)
+        workers.emplace_back(work);
+    work();
+    for (auto &worker : workers)
+        worker.join();
+
+    PAL_INFO(LOG_TAG, "Ssr up of %zu chains on %zu workers took %lld ms",
+             chains.size(), std::max(numWorkers, (size_t)1),
+             (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - begin).count());
+}
+
 int ResourceManager::initSndMonitor()
 {
     int ret = 0;
@@ -1388,18 +1534,6 @@ void ResourceManager::ssrHandler(card_status_t state)
     return;
 }
 
-char* ResourceManager::getDeviceNameFromID(uint32_t id)
-{
-    for (int i=0; i < devInfo.size(); i++) {
-        if (devInfo[i].deviceId == id) {
-            PAL_DBG(LOG_TAG, "pcm id name is %s ", devInfo[i].name);
-            return devInfo[i].name;
-        }
-    }
-
-    return NULL;
-}
-
 int ResourceManager::init_audio()
 {
     int retry = 0;
@@ -2157,17 +2291,10 @@ bool ResourceManager::getEcRefStatus(pal_stream_type_t tx_streamtype,pal_stream_
        PAL_DBG(LOG_TAG, "no need to enable ec for tx stream %d", tx_streamtype);
        return false;
     }
-    for (int i = 0; i < txEcInfo.size(); i++) {
-        if (tx_streamtype == txEcInfo[i].tx_stream_type) {
-            for (auto rx_type = txEcInfo[i].disabled_rx_streams.begin();
-                  rx_type != txEcInfo[i].disabled_rx_streams.end(); rx_type++) {
-               if (rx_streamtype == *rx_type) {
-                   ecref_status = false;
-                   PAL_DBG(LOG_TAG, "given rx %d disabled %d status %d",rx_streamtype, *rx_type, ecref_status);
-                   break;
-               }
-            }
-        }
+    if ((uint32_t)tx_streamtype < PAL_STREAM_MAX && (uint32_t)rx_streamtype < 64 &&
+        (ecRefDisabledRxMask[tx_streamtype] & (1ULL << rx_streamtype))) {
+        ecref_status = false;
+        PAL_DBG(LOG_TAG, "given rx %d disabled for tx %d", rx_streamtype, tx_streamtype);
     }
     return ecref_status;
 }
@@ -3079,6 +3206,7 @@ int registerstream(T s, std::list<T> &streams)
 int ResourceManager::registerStream(Stream *s)
 {
     int ret = 0;
+    int slot = 0;
     pal_stream_type_t type;
     PAL_DBG(LOG_TAG, "Enter. stream %pK", s);
     ret = s->getStreamType(&type);
@@ -3215,6 +3343,8 @@ int ResourceManager::registerStream(Stream *s)
             break;
     }
     mActiveStreams.push_back(s);
+    if (!ret && (slot = activeStreamSlot(type)) >= 0)
+        mActiveStreamSlots[slot].push_back({s, type});
 
 #if 0
     s->getStreamAttributes(&incomingStreamAttr);
@@ -3253,6 +3383,7 @@ int deregisterstream(T s, std::list<T> &streams)
 int ResourceManager::deregisterStream(Stream *s)
 {
     int ret = 0;
+    int slot = 0;
     pal_stream_type_t type;
     PAL_DBG(LOG_TAG, "Enter. stream %pK", s);
     ret = s->getStreamType(&type);
@@ -3397,6 +3528,16 @@ int ResourceManager::deregisterStream(Stream *s)
     }
 
     deregisterstream(s, mActiveStreams);
+    /* sessions release their front ends before the stream deregisters */
+    if (mActiveStreams.empty())
+        checkFrontEndLeaks();
+    if ((slot = activeStreamSlot(type)) >= 0) {
+        auto it = std::find_if(mActiveStreamSlots[slot].begin(), mActiveStreamSlots[slot].end(),
+                [s](const active_stream_entry &entry) { return entry.s == s; });
+        if (it != mActiveStreamSlots[slot].end())
+            mActiveStreamSlots[slot].erase(it);
+    }
+    freeStreamHandle_l(s);
 
     mActiveStreamMutex.unlock();
 exit:
@@ -3421,12 +3562,72 @@ bool isStreamActive(T s, std::list<T> &streams)
 }
 
 int ResourceManager::isActiveStream(pal_stream_handle_t *handle) {
-    for (auto &s : mActiveStreams) {
-        if (handle == reinterpret_cast<uint64_t *>(s)) {
-            return true;
-        }
-    }
-    return false;
+    return getStreamFromHandle(handle) != nullptr;
+}
+
+pal_stream_handle_t* ResourceManager::allocStreamHandle(Stream *s)
+{
+    uint32_t slot = 0;
+    uintptr_t handle = 0;
+
+    mActiveStreamMutex.lock();
+    if (mFreeStreamHandleSlots.empty()) {
+        mActiveStreamMutex.unlock();
+        PAL_ERR(LOG_TAG, "no free stream handle for stream %pK", s);
+        return NULL;
+    }
+    slot = mFreeStreamHandleSlots.back();
+    mFreeStreamHandleSlots.pop_back();
+    /* generation was already advanced when the slot was last released */
+    handle = ((uintptr_t)mStreamHandleTable[slot].generation.load(std::memory_order_relaxed)
+               << STREAM_HANDLE_SLOT_BITS) | slot;
+    mStreamHandleTable[slot].stream.store(s, std::memory_order_release);
+    s->setStreamHandle(reinterpret_cast<pal_stream_handle_t *>(handle));
+    mActiveStreamMutex.unlock();
+
+    PAL_DBG(LOG_TAG, "stream %pK handle %pK", s, (void *)handle);
+    return reinterpret_cast<pal_stream_handle_t *>(handle);
+}
+
+/* must be called with mActiveStreamMutex held */
+void ResourceManager::freeStreamHandle_l(Stream *s)
+{
+    uintptr_t handle = reinterpret_cast<uintptr_t>(s->getStreamHandle());
+    uint32_t slot = handle & (MAX_STREAM_HANDLES - 1);
+    uint32_t gen = 0;
+
+    if (!handle || mStreamHandleTable[slot].stream.load(std::memory_order_relaxed) != s)
+        return;
+
+    /*
+     * Advance generation before clearing the stream pointer so that a
+     * concurrent lookup with the old handle can never see a match.
+     */
+    gen = (mStreamHandleTable[slot].generation.load(std::memory_order_relaxed) + 1) &
+           STREAM_HANDLE_GEN_MASK;
+    if (!gen)
+        gen = 1;
+    mStreamHandleTable[slot].generation.store(gen, std::memory_order_release);
+    mStreamHandleTable[slot].stream.store(nullptr, std::memory_order_release);
+    mFreeStreamHandleSlots.push_back(slot);
+    s->setStreamHandle(NULL);
+}
+
+Stream* ResourceManager::getStreamFromHandle(pal_stream_handle_t *handle)
+{
+    uintptr_t value = reinterpret_cast<uintptr_t>(handle);
+    uint32_t slot = value & (MAX_STREAM_HANDLES - 1);
+    uint32_t gen = (value >> STREAM_HANDLE_SLOT_BITS) & STREAM_HANDLE_GEN_MASK;
+    Stream *s = nullptr;
+
+    if (mStreamHandleTable[slot].generation.load(std::memory_order_acquire) != gen)
+        return nullptr;
+    s = mStreamHandleTable[slot].stream.load(std::memory_order_acquire);
+    /* slot may have been released in between, recheck generation */
+    if (mStreamHandleTable[slot].generation.load(std::memory_order_acquire) != gen)
+        return nullptr;
+
+    return s;
 }
 
 int ResourceManager::initStreamUserCounter(Stream *s)
@@ -4680,41 +4881,64 @@ int ResourceManager::registerMixerEventCallback(const std::vector<int> &DevIds,
                                                 uint64_t cookie,
                                                 bool is_register) {
     int status = 0;
-    std::map<int, std::pair<session_callback, uint64_t>>::iterator it;
+    char *pcmDeviceName = NULL;
+    std::string ctlName;
+    std::shared_ptr<mixer_event_worker> worker = nullptr;
+    std::shared_ptr<mixer_event_binding> binding = nullptr;
 
     if (!callback || DevIds.size() <= 0) {
         PAL_ERR(LOG_TAG, "Invalid callback or pcm ids");
         return -EINVAL;
     }
 
-    mResourceManagerMutex.lock();
+    std::lock_guard<std::mutex> lock(mixerEventMutex);
     if (mixerEventRegisterCount == 0 && !is_register) {
         PAL_ERR(LOG_TAG, "Cannot deregister unregistered callback");
-        mResourceManagerMutex.unlock();
         return -EINVAL;
     }
 
     if (is_register) {
+        worker = getMixerEventWorker_l(callback);
         for (int i = 0; i < DevIds.size(); i++) {
-            it = mixerEventCallbackMap.find(DevIds[i]);
-            if (it != mixerEventCallbackMap.end()) {
+            if (DevIds[i] < 0)
+                continue;
+            binding = std::make_shared<mixer_event_binding>();
+            binding->cb = callback;
+            binding->cookie = cookie;
+            binding->worker = worker;
+            binding->revoked = false;
+            binding->ctl = NULL;
+            binding->numValues = 0;
+
+            /* resolve the event control now so dispatch skips the name lookup */
+            pcmDeviceName = getDeviceNameFromID(DevIds[i]);
+            if (pcmDeviceName) {
+                ctlName = std::string(pcmDeviceName) + " event";
+                binding->ctl = mixer_get_ctl_by_name(audio_virt_mixer, ctlName.c_str());
+                if (binding->ctl)
+                    binding->numValues = mixer_ctl_get_num_values(binding->ctl);
+            }
+
+            if (DevIds[i] >= mixerEventTable.size())
+                mixerEventTable.resize(DevIds[i] + 1);
+            if (mixerEventTable[DevIds[i]]) {
                 PAL_DBG(LOG_TAG, "callback exists for pcm id %d, overwrite",
                     DevIds[i]);
-                mixerEventCallbackMap.erase(it);
+                mixerEventTable[DevIds[i]]->revoked = true;
             }
-            mixerEventCallbackMap.insert(std::make_pair(DevIds[i],
-                std::make_pair(callback, cookie)));
-
+            mixerEventTable[DevIds[i]] = binding;
         }
         mixerEventRegisterCount++;
     } else {
         for (int i = 0; i < DevIds.size(); i++) {
-            it = mixerEventCallbackMap.find(DevIds[i]);
-            if (it != mixerEventCallbackMap.end()) {
+            if (DevIds[i] >= 0 && DevIds[i] < mixerEventTable.size() &&
+                mixerEventTable[DevIds[i]]) {
                 PAL_DBG(LOG_TAG, "callback found for pcm id %d, remove",
                     DevIds[i]);
-                if (callback == it->second.first) {
-                    mixerEventCallbackMap.erase(it);
+                if (callback == mixerEventTable[DevIds[i]]->cb) {
+                    /* drops events already queued on its worker */
+                    mixerEventTable[DevIds[i]]->revoked = true;
+                    mixerEventTable[DevIds[i]] = nullptr;
                 } else {
                     PAL_ERR(LOG_TAG, "No matching callback found for pcm id %d",
                         DevIds[i]);
@@ -4726,10 +4950,81 @@ int ResourceManager::registerMixerEventCallback(const std::vector<int> &DevIds,
         mixerEventRegisterCount--;
     }
 
-    mResourceManagerMutex.unlock();
     return status;
 }
 
+static void mixerEventWorkerLoop(mixer_event_worker *worker)
+{
+    std::function<void()> task;
+    std::unique_lock<std::mutex> lock(worker->mutex);
+
+    while (1) {
+        worker->cv.wait(lock, [worker] {
+            return worker->exit || !worker->queue.empty(); });
+        if (worker->exit)
+            break;
+        task = std::move(worker->queue.front());
+        worker->queue.pop_front();
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+    }
+}
+
+static int postMixerEventWork(mixer_event_worker *worker, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (worker->exit)
+            return -EPIPE;
+        worker->queue.push_back(std::move(task));
+    }
+    worker->cv.notify_one();
+    return 0;
+}
+
+/* Callers hold mixerEventMutex */
+std::shared_ptr<mixer_event_worker> ResourceManager::getMixerEventWorker_l(
+    session_callback cb)
+{
+    std::shared_ptr<mixer_event_worker> worker = nullptr;
+
+    for (auto &w : mixerEventWorkers) {
+        if (w->cb == cb)
+            return w;
+    }
+
+    worker = std::make_shared<mixer_event_worker>();
+    worker->cb = cb;
+    worker->exit = false;
+    worker->thread = std::thread(mixerEventWorkerLoop, worker.get());
+    mixerEventWorkers.push_back(worker);
+    PAL_DBG(LOG_TAG, "mixer event worker %zu started", mixerEventWorkers.size());
+    return worker;
+}
+
+/* Drops queued events and waits for the running callbacks to return */
+void ResourceManager::stopMixerEventWorkers()
+{
+    std::vector<std::shared_ptr<mixer_event_worker>> workers;
+
+    {
+        std::lock_guard<std::mutex> lock(mixerEventMutex);
+        workers.swap(mixerEventWorkers);
+    }
+    for (auto &worker : workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->exit = true;
+            worker->queue.clear();
+        }
+        worker->cv.notify_all();
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
 void ResourceManager::mixerEventWaitThreadLoop(
     std::shared_ptr<ResourceManager> rm) {
     int ret = 0;
@@ -4767,6 +5062,12 @@ void ResourceManager::mixerEventWaitThreadLoop(
         }
         if (ResourceManager::mixerClosed) {
             PAL_INFO(LOG_TAG, "mixerClosed, closed mixerEventWaitThreadLoop");
+            for (int i = 0; i < MIXER_EVENT_LATENCY_BUCKETS; i++) {
+                if (mixerEventLatencyHist[i])
+                    PAL_INFO(LOG_TAG, "event latency < %llu us: %llu",
+                             1ULL << (i + 1),
+                             (unsigned long long)mixerEventLatencyHist[i].load());
+            }
             return;
         }
     }
@@ -4774,50 +5075,112 @@ void ResourceManager::mixerEventWaitThreadLoop(
     mixer_subscribe_events(mixer, 0);
 }
 
+void ResourceManager::getMixerEventLatencyStats(uint64_t *hist, size_t count)
+{
+    if (!hist)
+        return;
+    for (size_t i = 0; i < count && i < MIXER_EVENT_LATENCY_BUCKETS; i++)
+        hist[i] = mixerEventLatencyHist[i].load(std::memory_order_relaxed);
+}
+
+// NOTE: event we get should be in format like "PCM100 event"
+static int parseMixerEventPcmId(const char *mixer_str, int *pcm_id)
+{
+    const char *start = NULL;
+    char *end = NULL;
+    long id = 0;
+
+    if ((start = strstr(mixer_str, "PCM")) != NULL)
+        start += strlen("PCM");
+    else if ((start = strstr(mixer_str, "COMPRESS")) != NULL)
+        start += strlen("COMPRESS");
+    else
+        return -EINVAL;
+
+    id = strtol(start, &end, 10);
+    if (end == start || id < 0 || strncmp(end, " event", strlen(" event")))
+        return -EINVAL;
+
+    *pcm_id = (int)id;
+    return 0;
+}
+
+/* recycled payload buffers keep steady-state dispatch allocation free */
+static std::vector<uint8_t> takeMixerEventBuf(mixer_event_binding *binding,
+                                              unsigned int size)
+{
+    std::vector<uint8_t> buf;
+    std::lock_guard<std::mutex> lock(binding->bufMutex);
+
+    if (!binding->spareBufs.empty()) {
+        buf = std::move(binding->spareBufs.back());
+        binding->spareBufs.pop_back();
+    }
+    buf.assign(size, 0);
+    return buf;
+}
+
+static void giveMixerEventBuf(mixer_event_binding *binding,
+                              std::vector<uint8_t> &buf)
+{
+    std::lock_guard<std::mutex> lock(binding->bufMutex);
+
+    if (binding->spareBufs.size() < MIXER_EVENT_SPARE_BUFS)
+        binding->spareBufs.push_back(std::move(buf));
+}
+
 int ResourceManager::handleMixerEvent(struct mixer *mixer, char *mixer_str) {
     int status = 0;
     int pcm_id = 0;
-    uint64_t cookie = 0;
-    session_callback session_cb = nullptr;
-    std::string event_str(mixer_str);
-    // TODO: hard code in common defs
-    std::string pcm_prefix = "PCM";
-    std::string compress_prefix = "COMPRESS";
-    std::string event_suffix = "event";
-    size_t prefix_idx = 0;
-    size_t suffix_idx = 0;
-    size_t length = 0;
     struct mixer_ctl *ctl = nullptr;
-    char *buf = nullptr;
-    unsigned int num_values;
+    unsigned int num_values = 0;
+    std::vector<uint8_t> buf;
     struct agm_event_cb_params *params = nullptr;
-    std::map<int, std::pair<session_callback, uint64_t>>::iterator it;
+    std::shared_ptr<mixer_event_binding> binding = nullptr;
+    std::chrono::steady_clock::time_point rxTime = std::chrono::steady_clock::now();
 
     PAL_DBG(LOG_TAG, "Enter");
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
-    if (!ctl) {
-        PAL_ERR(LOG_TAG, "Invalid mixer control: %s", mixer_str);
-        status = -EINVAL;
+    status = parseMixerEventPcmId(mixer_str, &pcm_id);
+    if (status) {
+        PAL_ERR(LOG_TAG, "Invalid mixer event");
         goto exit;
     }
 
-    // parse event payload
-    num_values = mixer_ctl_get_num_values(ctl);
-    PAL_VERBOSE(LOG_TAG, "num_values: %d", num_values);
-    buf = (char *)calloc(1, num_values);
-    if (!buf) {
-        PAL_ERR(LOG_TAG, "Failed to allocate buf");
-        status = -ENOMEM;
+    // acquire binding with pcm dev id
+    {
+        std::lock_guard<std::mutex> lock(mixerEventMutex);
+        if (pcm_id < mixerEventTable.size())
+            binding = mixerEventTable[pcm_id];
+    }
+
+    if (!binding) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid session callback");
         goto exit;
     }
 
-    status = mixer_ctl_get_array(ctl, buf, num_values);
+    ctl = binding->ctl;
+    num_values = binding->numValues;
+    if (!ctl) {
+        ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+        if (!ctl) {
+            PAL_ERR(LOG_TAG, "Invalid mixer control: %s", mixer_str);
+            status = -EINVAL;
+            goto exit;
+        }
+        num_values = mixer_ctl_get_num_values(ctl);
+    }
+
+    // parse event payload
+    PAL_VERBOSE(LOG_TAG, "num_values: %d", num_values);
+    buf = takeMixerEventBuf(binding.get(), num_values);
+    status = mixer_ctl_get_array(ctl, buf.data(), num_values);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "Failed to mixer_ctl_get_array");
         goto exit;
     }
 
-    params = (struct agm_event_cb_params *)buf;
+    params = (struct agm_event_cb_params *)buf.data();
     PAL_DBG(LOG_TAG, "source module id %x, event id %d, payload size %d",
             params->source_module_id, params->event_id,
             params->event_payload_size);
@@ -4827,51 +5190,28 @@ int ResourceManager::handleMixerEvent(struct mixer *mixer, char *mixer_str) {
         goto exit;
     }
 
-    // NOTE: event we get should be in format like "PCM100 event"
-    prefix_idx = event_str.find(pcm_prefix);
-    if (prefix_idx == event_str.npos) {
-        prefix_idx = event_str.find(compress_prefix);
-        if (prefix_idx == event_str.npos) {
-            PAL_ERR(LOG_TAG, "Invalid mixer event");
-            status = -EINVAL;
-            goto exit;
-        } else {
-            prefix_idx += compress_prefix.length();
-        }
-    } else {
-        prefix_idx += pcm_prefix.length();
-    }
-
-    suffix_idx = event_str.find(event_suffix);
-    if (suffix_idx == event_str.npos || suffix_idx - prefix_idx <= 1) {
-        PAL_ERR(LOG_TAG, "Invalid mixer event");
-        status = -EINVAL;
-        goto exit;
-    }
-
-    length = suffix_idx - prefix_idx;
-    pcm_id = std::stoi(event_str.substr(prefix_idx, length));
-
-    // acquire callback/cookie with pcm dev id
-    it = mixerEventCallbackMap.find(pcm_id);
-    if (it != mixerEventCallbackMap.end()) {
-        session_cb = it->second.first;
-        cookie = it->second.second;
-    }
+    // callback on the subscriber's worker, a slow client only delays its class
+    status = postMixerEventWork(binding->worker.get(),
+                                [binding, buf = std::move(buf), rxTime]() mutable {
+        struct agm_event_cb_params *p = (struct agm_event_cb_params *)buf.data();
+        uint64_t us = 0;
+        int bucket = 0;
 
-    if (!session_cb) {
-        status = -EINVAL;
-        PAL_ERR(LOG_TAG, "Invalid session callback");
-        goto exit;
-    }
-
-    // callback
-    session_cb(cookie, params->event_id, (void *)params->event_payload,
-                 params->event_payload_size, params->source_module_id);
+        if (!binding->revoked) {
+            us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - rxTime).count();
+            while ((us >>= 1) && bucket < MIXER_EVENT_LATENCY_BUCKETS - 1)
+                bucket++;
+            mixerEventLatencyHist[bucket]++;
+            binding->cb(binding->cookie, p->event_id, (void *)p->event_payload,
+                        p->event_payload_size, p->source_module_id);
+        }
+        giveMixerEventBuf(binding.get(), buf);
+    });
 
 exit:
-    if (buf)
-        free(buf);
+    if (binding && !buf.empty())
+        giveMixerEventBuf(binding.get(), buf);
     PAL_DBG(LOG_TAG, "Exit, status %d", status);
 
     return status;
@@ -5616,23 +5956,56 @@ void ResourceManager::getHigherPriorityActiveStreams(const int inComingStreamPri
 #endif
 
 
-template <class T>
-void getActiveStreams(std::shared_ptr<Device> d, std::vector<Stream*> &activestreams,
-                      std::list<T> sourcestreams)
+/*
+ * Bucket of a stream type in mActiveStreamSlots. Buckets follow the order
+ * getActiveStream_l() has always merged the per-type lists in, since
+ * callers pick activestreams[0]. Context proxy streams are never reported.
+ */
+int ResourceManager::activeStreamSlot(pal_stream_type_t type)
 {
-    for (typename std::list<T>::iterator iter = sourcestreams.begin();
-                 iter != sourcestreams.end(); iter++) {
-        std::vector <std::shared_ptr<Device>> devices;
-        (*iter)->getAssociatedDevices(devices);
-        if (d == NULL) {
-             if((*iter)->isAlive() && !devices.empty())
-                activestreams.push_back(*iter);
-        } else {
-            typename std::vector<std::shared_ptr<Device>>::iterator result =
-                     std::find(devices.begin(), devices.end(), d);
-            if ((result != devices.end()) && (*iter)->isAlive())
-                activestreams.push_back(*iter);
-        }
+    switch (type) {
+        case PAL_STREAM_LOW_LATENCY:
+        case PAL_STREAM_VOIP_RX:
+        case PAL_STREAM_VOIP_TX:
+        case PAL_STREAM_VOICE_CALL:
+            return 0;
+        case PAL_STREAM_ULTRA_LOW_LATENCY:
+            return 1;
+        case PAL_STREAM_GENERIC:
+            return 2;
+        case PAL_STREAM_DEEP_BUFFER:
+            return 3;
+        case PAL_STREAM_SPATIAL_AUDIO:
+            return 4;
+        case PAL_STREAM_RAW:
+            return 5;
+        case PAL_STREAM_COMPRESSED:
+            return 6;
+        case PAL_STREAM_VOICE_UI:
+            return 7;
+        case PAL_STREAM_ACD:
+            return 8;
+        case PAL_STREAM_PCM_OFFLOAD:
+        case PAL_STREAM_LOOPBACK:
+            return 9;
+        case PAL_STREAM_PROXY:
+            return 10;
+        case PAL_STREAM_VOICE_CALL_RECORD:
+            return 11;
+        case PAL_STREAM_NON_TUNNEL:
+            return 12;
+        case PAL_STREAM_VOICE_CALL_MUSIC:
+            return 13;
+        case PAL_STREAM_HAPTICS:
+            return 14;
+        case PAL_STREAM_ULTRASOUND:
+            return 15;
+        case PAL_STREAM_SENSOR_PCM_DATA:
+            return 16;
+        case PAL_STREAM_VOICE_RECOGNITION:
+            return 17;
+        default:
+            return -EINVAL;
     }
 }
 
@@ -5644,24 +6017,14 @@ int ResourceManager::getActiveStream_l(std::vector<Stream*> &activestreams,
     activestreams.clear();
 
     // merge all types of active streams into activestreams
-    getActiveStreams(d, activestreams, active_streams_ll);
-    getActiveStreams(d, activestreams, active_streams_ull);
-    getActiveStreams(d, activestreams, active_streams_ulla);
-    getActiveStreams(d, activestreams, active_streams_db);
-    getActiveStreams(d, activestreams, active_streams_sa);
-    getActiveStreams(d, activestreams, active_streams_raw);
-    getActiveStreams(d, activestreams, active_streams_comp);
-    getActiveStreams(d, activestreams, active_streams_st);
-    getActiveStreams(d, activestreams, active_streams_acd);
-    getActiveStreams(d, activestreams, active_streams_po);
-    getActiveStreams(d, activestreams, active_streams_proxy);
-    getActiveStreams(d, activestreams, active_streams_incall_record);
-    getActiveStreams(d, activestreams, active_streams_non_tunnel);
-    getActiveStreams(d, activestreams, active_streams_incall_music);
-    getActiveStreams(d, activestreams, active_streams_haptics);
-    getActiveStreams(d, activestreams, active_streams_ultrasound);
-    getActiveStreams(d, activestreams, active_streams_sensor_pcm_data);
-    getActiveStreams(d, activestreams, active_streams_voice_rec);
+    for (auto &slot : mActiveStreamSlots) {
+        for (auto &entry : slot) {
+            if (!entry.s->isAlive())
+                continue;
+            if (d ? entry.s->isDeviceAssociated(d) : entry.s->hasAssociatedDevices())
+                activestreams.push_back(entry.s);
+        }
+    }
 
     if (activestreams.empty()) {
         ret = -ENOENT;
@@ -5675,6 +6038,24 @@ int ResourceManager::getActiveStream_l(std::vector<Stream*> &activestreams,
     return ret;
 }
 
+/* All registered streams of one type, alive or not, in registration order */
+int ResourceManager::getActiveStreamsOfType_l(pal_stream_type_t type,
+                                              std::vector<Stream*> &activestreams)
+{
+    int slot = activeStreamSlot(type);
+
+    activestreams.clear();
+    if (slot < 0)
+        return -EINVAL;
+
+    for (auto &entry : mActiveStreamSlots[slot]) {
+        if (entry.type == type)
+            activestreams.push_back(entry.s);
+    }
+
+    return activestreams.empty() ? -ENOENT : 0;
+}
+
 int ResourceManager::getActiveStream(std::vector<Stream*> &activestreams,
                                      std::shared_ptr<Device> d)
 {
@@ -6064,14 +6445,9 @@ int ResourceManager::checkAndUpdateGroupDevConfig(struct pal_device *deviceattr,
                         // if coming usecase is not voice call but voice call already active
                         // still set group config for speaker as voice speaker
                         } else {
-                            pal_stream_type_t type;
-                            for (auto& str: mActiveStreams) {
-                                str->getStreamType(&type);
-                                if (type == PAL_STREAM_VOICE_CALL) {
-                                    group_cfg_idx = GRP_SPEAKER_VOICE;
-                                    break;
-                                }
-                            }
+                            std::vector<Stream*> voiceStreams;
+                            if (getActiveStreamsOfType_l(PAL_STREAM_VOICE_CALL, voiceStreams) == 0)
+                                group_cfg_idx = GRP_SPEAKER_VOICE;
                         }
                     }
                 }
@@ -6113,7 +6489,6 @@ int ResourceManager::checkAndUpdateGroupDevConfig(struct pal_device *deviceattr,
 
 void ResourceManager::checkAndSetDutyCycleParam()
 {
-    pal_stream_attributes StrAttr;
     std::shared_ptr<Device> dev = nullptr;
     struct pal_device DevAttr;
     std::string backEndName;
@@ -6131,10 +6506,9 @@ void ResourceManager::checkAndSetDutyCycleParam()
     }
 
     // check if UPD is already active
-    for (auto& str: mActiveStreams) {
-        str->getStreamAttributes(&StrAttr);
-        if (StrAttr.type == PAL_STREAM_ULTRASOUND &&
-            str->isActive()) {
+    getActiveStreamsOfType_l(PAL_STREAM_ULTRASOUND, activeStream);
+    for (auto& str: activeStream) {
+        if (str->isActive()) {
             is_upd_active = true;
             // enable duty by default, this may change based on concurrency.
             // during device switch, upd stream can active, but RX device is
@@ -6144,8 +6518,6 @@ void ResourceManager::checkAndSetDutyCycleParam()
                 enable_duty = true;
             UPDStream = str;
             break;
-        } else {
-            continue;
         }
     }
 
@@ -6297,6 +6669,8 @@ void ResourceManager::deinit()
     card_status_t state = CARD_STATUS_NONE;
 
     mixerClosed = true;
+    SessionAlsaUtils::invalidateMixerCtlCache();
+    SessionAlsaUtils::invalidateMiidCache();
     mixer_close(audio_virt_mixer);
     mixer_close(audio_hw_mixer);
     if (audio_route) {
@@ -6306,6 +6680,7 @@ void ResourceManager::deinit()
         mixerEventTread.join();
     }
     PAL_DBG(LOG_TAG, "Mixer event thread joined");
+    stopMixerEventWorkers();
     if (sndmon)
         delete sndmon;
 
@@ -6428,24 +6803,14 @@ int ResourceManager::getNumFEs(const pal_stream_type_t sType) const
 const std::vector<int> ResourceManager::allocateFrontEndExtEcIds()
 {
     std::vector<int> f;
-    f.clear();
-    const int howMany = 1;
-    int id = 0;
-    std::vector<int>::iterator it;
-    if (howMany > listAllPcmExtEcTxFrontEnds.size()) {
-        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: requested for %d external ec front ends, have only %zu error",
-                        howMany, listAllPcmExtEcTxFrontEnds.size());
+    int id = pcmExtEcTxFrontEnds.allocate();
+
+    if (id < 0) {
+        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: no external ec front end available");
         return f;
     }
-    id = (listAllPcmExtEcTxFrontEnds.size() - 1);
-    it =  (listAllPcmExtEcTxFrontEnds.begin() + id);
-    for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmExtEcTxFrontEnds.at(id));
-        listAllPcmExtEcTxFrontEnds.erase(it);
-        PAL_INFO(LOG_TAG, "allocateFrontEndExtEcIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
-    }
+    f.push_back(id);
+    PAL_INFO(LOG_TAG, "allocateFrontEndExtEcIds: front end %d", id);
     return f;
 }
 
@@ -6453,46 +6818,20 @@ void ResourceManager::freeFrontEndEcTxIds(const std::vector<int> frontend)
 {
     for (int i = 0; i < frontend.size(); i++) {
         PAL_INFO(LOG_TAG, "freeing ext ec dev %d\n", frontend.at(i));
-        listAllPcmExtEcTxFrontEnds.push_back(frontend.at(i));
+        pcmExtEcTxFrontEnds.release(frontend.at(i));
     }
     return;
 }
 
-template <typename T>
-void removeDuplicates(std::vector<T> &vec)
+/* Pool a stream draws its front ends from, nullptr if it uses none */
+FrontEndPool *ResourceManager::getFrontEndPool(const struct pal_stream_attributes &sAttr,
+                                               int lDirection)
 {
-    std::sort(vec.begin(), vec.end());
-    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
-    return;
-}
+    bool isVoice1 = false;
 
-const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr, int lDirection)
-{
-    //TODO: lock resource manager
-    std::vector<int> f;
-    f.clear();
-    const int howMany = getNumFEs(sAttr.type);
-    int id = 0;
-    std::vector<int>::iterator it;
-
-    mListFrontEndsMutex.lock();
-    switch(sAttr.type) {
+    switch (sAttr.type) {
         case PAL_STREAM_NON_TUNNEL:
-            if (howMany > listAllNonTunnelSessionIds.size()) {
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                howMany, listAllPcmRecordFrontEnds.size());
-                 goto error;
-            }
-            id = (listAllNonTunnelSessionIds.size() - 1);
-            it =  (listAllNonTunnelSessionIds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllNonTunnelSessionIds.at(id));
-                listAllNonTunnelSessionIds.erase(it);
-                PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &nonTunnelSessionIds;
         case PAL_STREAM_LOW_LATENCY:
         case PAL_STREAM_ULTRA_LOW_LATENCY:
         case PAL_STREAM_GENERIC:
@@ -6513,406 +6852,155 @@ const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_str
         case PAL_STREAM_VOICE_RECOGNITION:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmRecordFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmRecordFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmRecordFrontEnds.size() - 1);
-                        it = (listAllPcmRecordFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                            f.push_back(listAllPcmRecordFrontEnds.at(id));
-                            listAllPcmRecordFrontEnds.erase(it);
-                            PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                            it -= 1;
-                            id -= 1;
-                        }
-                    }
-                    break;
+                    return lDirection == TX_HOSTLESS ? &pcmHostlessTxFrontEnds :
+                                                       &pcmRecordFrontEnds;
                 case PAL_AUDIO_OUTPUT:
-                    if (howMany > listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    if (!listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, but we dont have any (%zu) !!!!!!! ",
-                                howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    id = (int)(((int)listAllPcmPlaybackFrontEnds.size()) - 1);
-                    if (id < 0) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: negative iterator id %d !!!!! ", id);
-                        goto error;
-                    }
-                    it =  (listAllPcmPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllPcmPlaybackFrontEnds.at(id));
-                        listAllPcmPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &pcmPlaybackFrontEnds;
                 case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessRxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessRxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessRxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessRxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessRxFrontEnds.at(id));
-                           listAllPcmHostlessRxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    }
-                    break;
+                    return lDirection == RX_HOSTLESS ? &pcmHostlessRxFrontEnds :
+                                                       &pcmHostlessTxFrontEnds;
                 default:
                     PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
+                    return nullptr;
             }
-            break;
         case PAL_STREAM_COMPRESSED:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (howMany > listAllCompressRecordFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressRecordFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressRecordFrontEnds.size() - 1);
-                    it = (listAllCompressRecordFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressRecordFrontEnds.at(id));
-                        listAllCompressRecordFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &compressRecordFrontEnds;
                 case PAL_AUDIO_OUTPUT:
-                    if (howMany > listAllCompressPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressPlaybackFrontEnds.size() - 1);
-                    it = (listAllCompressPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressPlaybackFrontEnds.at(id));
-                        listAllCompressPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &compressPlaybackFrontEnds;
                 default:
                     PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-                }
-                break;
-        case PAL_STREAM_VOICE_CALL:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1RxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2RxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    } else {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1TxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2TxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    }
-                    break;
-              default:
-                  PAL_ERR(LOG_TAG,"direction unsupported voice must be RX and TX");
-                  break;
+                    return nullptr;
             }
-            break;
+        case PAL_STREAM_VOICE_CALL:
+            if (sAttr.direction != (PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT)) {
+                PAL_ERR(LOG_TAG,"direction unsupported voice must be RX and TX");
+                return nullptr;
+            }
+            if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
+                sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
+                isVoice1 = true;
+            } else if (sAttr.info.voice_call_info.VSID != VOICEMMODE2 &&
+                       sAttr.info.voice_call_info.VSID != VOICELBMMODE2) {
+                PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
+                        sAttr.info.voice_call_info.VSID);
+                return nullptr;
+            }
+            if (lDirection == RX_HOSTLESS)
+                return isVoice1 ? &pcmVoice1RxFrontEnds : &pcmVoice2RxFrontEnds;
+            return isVoice1 ? &pcmVoice1TxFrontEnds : &pcmVoice2TxFrontEnds;
         case PAL_STREAM_VOICE_CALL_RECORD:
-            if (howMany > listAllPcmInCallRecordFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallRecordFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallRecordFrontEnds.size() - 1);
-            it = (listAllPcmInCallRecordFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallRecordFrontEnds.at(id));
-                listAllPcmInCallRecordFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &pcmInCallRecordFrontEnds;
         case PAL_STREAM_VOICE_CALL_MUSIC:
-            if (howMany > listAllPcmInCallMusicFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallMusicFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallMusicFrontEnds.size() - 1);
-            it = (listAllPcmInCallMusicFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallMusicFrontEnds.at(id));
-                listAllPcmInCallMusicFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            if (howMany > listAllPcmContextProxyFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmContextProxyFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmContextProxyFrontEnds.size() - 1);
-            it = (listAllPcmContextProxyFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmContextProxyFrontEnds.at(id));
-                listAllPcmContextProxyFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &pcmInCallMusicFrontEnds;
+        case PAL_STREAM_CONTEXT_PROXY:
+            return &pcmContextProxyFrontEnds;
         default:
+            return nullptr;
+    }
+}
+
+const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr, int lDirection)
+{
+    std::vector<int> f;
+    const int howMany = getNumFEs(sAttr.type);
+    FrontEndPool *pool = getFrontEndPool(sAttr, lDirection);
+    int id = 0;
+
+    if (!pool)
+        return f;
+
+    if (sAttr.type == PAL_STREAM_VOICE_CALL)
+        return allocateVoiceFrontEndIds(*pool, howMany);
+
+    for (int i = 0; i < howMany; i++) {
+        id = pool->allocate();
+        if (id < 0) {
+            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %d error",
+                    howMany, i);
+            for (auto fe : f)
+                pool->release(fe);
+            f.clear();
             break;
+        }
+        f.push_back(id);
+        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", id);
     }
 
-error:
-    mListFrontEndsMutex.unlock();
     return f;
 }
 
-
-const std::vector<int> ResourceManager::allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds, const int howMany)
+/*
+ * Voice front ends are tied to the VSID rather than to a session and are
+ * never handed out exclusively: every voice session of a VSID gets the
+ * last howMany ids of its pool.
+ */
+const std::vector<int> ResourceManager::allocateVoiceFrontEndIds(const FrontEndPool &pool, const int howMany)
 {
     std::vector<int> f;
-    f.clear();
-    int id = 0;
-    std::vector<int>::iterator it;
-    if ( howMany > listAllPcmVoiceFrontEnds.size()) {
+
+    if (howMany > pool.capacity()) {
         PAL_ERR(LOG_TAG, "allocate voice FrontEndIds: requested for %d front ends, have only %zu error",
-                howMany, listAllPcmVoiceFrontEnds.size());
+                howMany, pool.capacity());
         return f;
     }
-    id = (listAllPcmVoiceFrontEnds.size() - 1);
-    it =  (listAllPcmVoiceFrontEnds.begin() + id);
     for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmVoiceFrontEnds.at(id));
-        listAllPcmVoiceFrontEnds.erase(it);
+        f.push_back(pool.getId(pool.capacity() - 1 - i));
         PAL_INFO(LOG_TAG, "allocate VoiceFrontEndIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
     }
 
     return f;
 }
+
 void ResourceManager::freeFrontEndIds(const std::vector<int> frontend,
                                       const struct pal_stream_attributes sAttr,
                                       int lDirection)
 {
-    mListFrontEndsMutex.lock();
+    FrontEndPool *pool = nullptr;
+
     if (frontend.size() <= 0) {
         PAL_ERR(LOG_TAG,"frontend size is invalid");
-        mListFrontEndsMutex.unlock();
         return;
     }
     PAL_INFO(LOG_TAG, "stream type %d, freeing %d\n", sAttr.type,
              frontend.at(0));
 
-    switch(sAttr.type) {
-        case PAL_STREAM_NON_TUNNEL:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllNonTunnelSessionIds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllNonTunnelSessionIds);
-            break;
-        case PAL_STREAM_LOW_LATENCY:
-        case PAL_STREAM_ULTRA_LOW_LATENCY:
-        case PAL_STREAM_GENERIC:
-        case PAL_STREAM_PROXY:
-        case PAL_STREAM_DEEP_BUFFER:
-        case PAL_STREAM_SPATIAL_AUDIO:
-        case PAL_STREAM_VOIP:
-        case PAL_STREAM_VOIP_RX:
-        case PAL_STREAM_VOIP_TX:
-        case PAL_STREAM_VOICE_UI:
-        case PAL_STREAM_LOOPBACK:
-        case PAL_STREAM_ACD:
-        case PAL_STREAM_PCM_OFFLOAD:
-        case PAL_STREAM_HAPTICS:
-        case PAL_STREAM_ULTRASOUND:
-        case PAL_STREAM_SENSOR_PCM_DATA:
-        case PAL_STREAM_RAW:
-        case PAL_STREAM_VOICE_RECOGNITION:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmRecordFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmRecordFrontEnds);
-                    }
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllPcmPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllPcmPlaybackFrontEnds);
-                    break;
-                case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessRxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessRxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    }
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-            }
-            break;
+    /* see allocateVoiceFrontEndIds(), voice front ends stay in their pool */
+    if (sAttr.type == PAL_STREAM_VOICE_CALL)
+        return;
 
-        case PAL_STREAM_VOICE_CALL:
-            if (lDirection == RX_HOSTLESS) {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1RxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2RxFrontEnds.push_back(frontend.at(i));
-                    }
+    pool = getFrontEndPool(sAttr, lDirection);
+    if (!pool)
+        return;
 
-                }
-                removeDuplicates(listAllPcmVoice1RxFrontEnds);
-                removeDuplicates(listAllPcmVoice2RxFrontEnds);
-            } else {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1TxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2TxFrontEnds.push_back(frontend.at(i));
-                    }
-                }
-                removeDuplicates(listAllPcmVoice1TxFrontEnds);
-                removeDuplicates(listAllPcmVoice2TxFrontEnds);
-            }
-            break;
+    for (int i = 0; i < frontend.size(); i++)
+        pool->release(frontend.at(i));
+    return;
+}
 
-        case PAL_STREAM_COMPRESSED:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressRecordFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressRecordFrontEnds);
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressPlaybackFrontEnds);
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-                }
-            break;
-        case PAL_STREAM_VOICE_CALL_RECORD:
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallRecordFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallRecordFrontEnds);
-                break;
-              case PAL_AUDIO_OUTPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallMusicFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallMusicFrontEnds);
-                break;
-              default:
-                break;
-            }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllPcmContextProxyFrontEnds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllPcmContextProxyFrontEnds);
-            break;
-        default:
-            break;
+void ResourceManager::getFrontEndPoolStats(std::vector<struct fe_pool_stats> &stats)
+{
+    struct fe_pool_stats poolStats;
+
+    stats.clear();
+    for (auto pool : frontEndPools) {
+        pool->getStats(&poolStats);
+        stats.push_back(poolStats);
     }
-    mListFrontEndsMutex.unlock();
-    return;
+}
+
+/* Logs every front end still allocated and returns how many there are */
+uint32_t ResourceManager::checkFrontEndLeaks()
+{
+    uint32_t leaked = 0;
+
+    for (auto pool : frontEndPools)
+        leaked += pool->checkLeaks();
+    if (leaked)
+        PAL_ERR(LOG_TAG, "%u front end(s) not freed with no stream open", leaked);
+
+    return leaked;
 }
 
 void ResourceManager::getSharedBEActiveStreamDevs(std::vector <std::tuple<Stream *, uint32_t>> &activeStreamsDevices,
@@ -9173,6 +9261,69 @@ int ResourceManager::getParameter(uint32_t param_id, void **param_payload,
             }
         }
         break;
+        case PAL_PARAM_ID_SP_GET_TELEMETRY:
+        {
+            PAL_VERBOSE(LOG_TAG, "get parameter for speaker telemetry");
+            std::shared_ptr<Device> dev = nullptr;
+            struct pal_device dattr;
+            dattr.id = PAL_DEVICE_OUT_SPEAKER;
+            dev = Device::getInstance(&dattr , rm);
+            if (dev) {
+                status = dev->getParameter(PAL_PARAM_ID_SP_GET_TELEMETRY,
+                                    param_payload);
+                if (status < 0) {
+                    PAL_ERR(LOG_TAG, "speaker telemetry query failed %d", status);
+                    goto exit;
+                }
+                *payload_size = status;
+                status = 0;
+            }
+        }
+        break;
+        case PAL_PARAM_ID_FE_POOL_STATS:
+        {
+            PAL_VERBOSE(LOG_TAG, "get parameter for front end pool stats");
+            pal_param_fe_pool_stats_t *param_fe_pools = nullptr;
+            std::vector<struct fe_pool_stats> stats;
+
+            if (!param_payload || !*param_payload) {
+                PAL_ERR(LOG_TAG, "Invalid front end pool stats payload");
+                status = -EINVAL;
+                goto exit;
+            }
+            param_fe_pools = (pal_param_fe_pool_stats_t *)(*param_payload);
+            getFrontEndPoolStats(stats);
+            param_fe_pools->num_pools = std::min((size_t)param_fe_pools->max_pools,
+                                                 stats.size());
+            for (uint32_t i = 0; i < param_fe_pools->num_pools; i++) {
+                pal_fe_pool_stats_t *pool = &param_fe_pools->pools[i];
+
+                strlcpy(pool->name, stats[i].name, PAL_FE_POOL_NAME_LEN);
+                pool->capacity = stats[i].capacity;
+                pool->in_use = stats[i].inUse;
+                pool->peak = stats[i].peak;
+                pool->failures = stats[i].failures;
+            }
+            *payload_size = sizeof(pal_param_fe_pool_stats_t) +
+                            param_fe_pools->num_pools * sizeof(pal_fe_pool_stats_t);
+        }
+        break;
+        case PAL_PARAM_ID_MIXER_EVENT_LATENCY:
+        {
+            PAL_VERBOSE(LOG_TAG, "get parameter for mixer event latency");
+            pal_param_mixer_event_latency_t *param_latency = nullptr;
+
+            if (!param_payload || !*param_payload) {
+                PAL_ERR(LOG_TAG, "Invalid mixer event latency payload");
+                status = -EINVAL;
+                goto exit;
+            }
+            param_latency = (pal_param_mixer_event_latency_t *)(*param_payload);
+            getMixerEventLatencyStats(param_latency->count,
+                                      PAL_MIXER_EVENT_LATENCY_BUCKETS);
+            *payload_size = sizeof(pal_param_mixer_event_latency_t);
+        }
+        break;
         case PAL_PARAM_ID_SNDCARD_STATE:
         {
             PAL_VERBOSE(LOG_TAG, "get parameter for sndcard state");
@@ -11240,6 +11391,12 @@ void ResourceManager::processDeviceIdProp(struct xml_userdata *data, const XML_C
         device = atoi(data->data_buf);
         dev.deviceId = device;
         devInfo.push_back(dev);
+        if (device >= 0) {
+            if (device >= devInfoIndex.size())
+                devInfoIndex.resize(device + 1, -1);
+            if (devInfoIndex[device] < 0)
+                devInfoIndex[device] = devInfo.size() - 1;
+        }
     } else if (!strcmp(tag_name, "name")) {
         size = devInfo.size() - 1;
         strlcpy(devInfo[size].name, data->data_buf, strlen(data->data_buf)+1);
@@ -11632,6 +11789,8 @@ void ResourceManager::process_device_info(struct xml_userdata *data, const XML_C
                 isMainSpeakerRight = true;
         } else if (!strcmp(tag_name, "quick_cal_time")) {
             spQuickCalTime = atoi(data->data_buf);
+        } else if (!strcmp(tag_name, "xmax_tmax_log_interval")) {
+            spXmaxTmaxLogInterval = atoi(data->data_buf);
         }else if (!strcmp(tag_name, "ras_enabled")) {
             if (atoi(data->data_buf))
                 isRasEnabled = true;
@@ -11791,6 +11950,11 @@ void ResourceManager::process_input_streams(struct xml_userdata *data, const XML
             type  = usecaseIdLUT.at(userIdname);
             size = txEcInfo.size() - 1;
             txEcInfo[size].disabled_rx_streams.push_back(type);
+            if (txEcInfo[size].tx_stream_type < PAL_STREAM_MAX && type < 64)
+                ecRefDisabledRxMask[txEcInfo[size].tx_stream_type] |= 1ULL << type;
+            else
+                PAL_ERR(LOG_TAG, "ecref %d for tx %d out of range", type,
+                        txEcInfo[size].tx_stream_type);
             PAL_DBG(LOG_TAG, "ecref %d", type);
         }
     }
@@ -12116,7 +12280,8 @@ int ResourceManager::XmlParser(std::string xmlFile)
     XML_Parser parser;
     FILE *file = NULL;
     int ret = 0;
-    int bytes_read;
+    long bytes_read;
+    long file_size = 0;
     void *buf = NULL;
     struct xml_userdata data;
     memset(&data, 0, sizeof(data));
@@ -12141,28 +12306,32 @@ int ResourceManager::XmlParser(std::string xmlFile)
     XML_SetElementHandler(parser, startTag, endTag);
     XML_SetCharacterDataHandler(parser, snd_data_handler);
 
-    while (1) {
-        buf = XML_GetBuffer(parser, 1024);
-        if(buf == NULL) {
-            ret = -EINVAL;
-            PAL_ERR(LOG_TAG, "XML_Getbuffer failed ret %d", ret);
-            goto freeParser;
-        }
+    /* Hand expat the whole file in one buffer instead of 1 KB chunks */
+    if (fseek(file, 0, SEEK_END) || (file_size = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET)) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "Failed to get size of %s ret %d", xmlFile.c_str(), ret);
+        goto freeParser;
+    }
 
-        bytes_read = fread(buf, 1, 1024, file);
-        if(bytes_read < 0) {
-            ret = -EINVAL;
-            PAL_ERR(LOG_TAG, "fread failed ret %d", ret);
-            goto freeParser;
-        }
+    buf = XML_GetBuffer(parser, file_size);
+    if(buf == NULL) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "XML_Getbuffer failed ret %d", ret);
+        goto freeParser;
+    }
 
-        if(XML_ParseBuffer(parser, bytes_read, bytes_read == 0) == XML_STATUS_ERROR) {
-            ret = -EINVAL;
-            PAL_ERR(LOG_TAG, "XML ParseBuffer failed for %s file ret %d", xmlFile.c_str(), ret);
-            goto freeParser;
-        }
-        if (bytes_read == 0)
-            break;
+    bytes_read = fread(buf, 1, file_size, file);
+    if(bytes_read != file_size) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "fread failed ret %d", ret);
+        goto freeParser;
+    }
+
+    if(XML_ParseBuffer(parser, bytes_read, 1) == XML_STATUS_ERROR) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "XML ParseBuffer failed for %s file ret %d", xmlFile.c_str(), ret);
+        goto freeParser;
     }
 
 freeParser:
@@ -44,14 +44,17 @@
 #include <algorithm>
 #include <expat.h>
 #include <map>
+#include <unordered_map>
 #include <regex>
 #include <sstream>
 #include "Stream.h"
 #include "Device.h"
 #include "ResourceManager.h"
+#include "UsecaseKvIndex.h"
 
 #define PAL_ALIGN_8BYTE(x) (((x) + 7) & (~7))
 #define PAL_PADDING_8BYTE_ALIGN(x)  ((((x) + 7) & 7) ^ 7)
+#define PAYLOAD_ARENA_INLINE_SIZE 256
 
 #define MSM_MI2S_SD0 (1 << 0)
 #define MSM_MI2S_SD1 (1 << 1)
@@ -97,58 +100,6 @@ struct dpAudioConfig{
   uint32_t dptx_idx;
 };
 
-typedef enum {
-    DIRECTION_SEL = 1,
-    BITWIDTH_SEL,
-    INSTANCE_SEL,
-    SUB_TYPE_SEL,
-    VSID_SEL,
-    VUI_MODULE_TYPE_SEL,
-    ACD_MODULE_TYPE_SEL,
-    STREAM_TYPE_SEL,
-    CODECFORMAT_SEL,
-    ABR_ENABLED_SEL,
-    AUD_FMT_SEL,
-    DEVICEPP_TYPE_SEL,
-    CUSTOM_CONFIG_SEL,
-    HOSTLESS_SEL,
-    SIDETONE_MODE_SEL,
-} selector_type_t;
-
-const std::map<std::string, selector_type_t> selectorstypeLUT {
-    {std::string{ "Direction" },             DIRECTION_SEL},
-    {std::string{ "BitWidth" },              BITWIDTH_SEL},
-    {std::string{ "Instance" },              INSTANCE_SEL},
-    {std::string{ "SubType" },               SUB_TYPE_SEL},
-    {std::string{ "VSID" },                  VSID_SEL},
-    {std::string{ "VUIModuleType" },         VUI_MODULE_TYPE_SEL},
-    {std::string{ "ACDModuleType" },         ACD_MODULE_TYPE_SEL},
-    {std::string{ "StreamType" },            STREAM_TYPE_SEL},
-    {std::string{ "DevicePPType" },          DEVICEPP_TYPE_SEL},
-    {std::string{ "CodecFormat" },           CODECFORMAT_SEL},
-    {std::string{ "AbrEnabled" },            ABR_ENABLED_SEL},
-    {std::string{ "AudioFormat" },           AUD_FMT_SEL},
-    {std::string{ "CustomConfig" },          CUSTOM_CONFIG_SEL},
-    {std::string{ "Hostless" },              HOSTLESS_SEL},
-    {std::string{ "SidetoneMode" },          SIDETONE_MODE_SEL},
-};
-
-struct kvPairs {
-    unsigned int key;
-    unsigned int value;
-};
-
-struct kvInfo {
-    std::vector<std::string> selector_names;
-    std::vector<std::pair<selector_type_t, std::string>> selector_pairs;
-    std::vector<kvPairs> kv_pairs;
-};
-
-struct allKVs {
-    std::vector<int> id_type;
-    std::vector<kvInfo> keys_values;
-};
-
 typedef enum {
     TAG_USECASEXML_ROOT,
     TAG_STREAM_SEL,
@@ -175,6 +126,28 @@ struct user_xml_data{
 };
 class SessionGsl;
 
+/*
+ * Caller-owned scratch storage for payload* builders. Each alloc() returns
+ * zeroed, 8-byte aligned memory and invalidates the previous allocation, so
+ * one arena serves one payload at a time and is reused across calls. Small
+ * payloads are served from the inline buffer without touching the heap.
+ * Memory handed out by an arena must never be passed to free().
+ */
+class PayloadArena
+{
+public:
+    PayloadArena() : heap(nullptr), heapSize(0) {}
+    ~PayloadArena() { free(heap); }
+    PayloadArena(const PayloadArena&) = delete;
+    PayloadArena& operator=(const PayloadArena&) = delete;
+    uint8_t* alloc(size_t size);
+    bool owns(const uint8_t *ptr) const;
+private:
+    uint64_t inlineBuf[PAYLOAD_ARENA_INLINE_SIZE / sizeof(uint64_t)];
+    uint8_t *heap;
+    size_t heapSize;
+};
+
 class PayloadBuilder
 {
 protected:
@@ -182,6 +155,10 @@ protected:
    static std::vector<allKVs> all_streampps;
    static std::vector<allKVs> all_devices;
    static std::vector<allKVs> all_devicepps;
+   static kvTypeIndex all_streams_index;
+   static kvTypeIndex all_streampps_index;
+   static kvTypeIndex all_devices_index;
+   static kvTypeIndex all_devicepps_index;
 
 public:
     void payloadUsbAudioConfig(uint8_t** payload, size_t* size,
@@ -194,15 +171,18 @@ public:
          uint32_t miid, uint32_t ramp_period_ms);
     void payloadMFCConfig(uint8_t** payload, size_t* size,
                            uint32_t miid,
-                           struct sessionToPayloadParam* data);
+                           struct sessionToPayloadParam* data,
+                           PayloadArena *arena = nullptr);
     void payloadMFCMixerCoeff(uint8_t** payload, size_t* size,
                            uint32_t miid, int numCh, int rotationType);
     void payloadVolumeConfig(uint8_t** payload, size_t* size,
                            uint32_t miid,
-                           struct pal_volume_data * data);
+                           struct pal_volume_data * data,
+                           PayloadArena *arena = nullptr);
     void payloadMultichVolumemConfig(uint8_t** payload, size_t* size,
                            uint32_t miid,
-                           struct pal_volume_data * data);
+                           struct pal_volume_data * data,
+                           PayloadArena *arena = nullptr);
     int payloadCustomParam(uint8_t **alsaPayload, size_t *size,
                             uint32_t *customayload, uint32_t customPayloadSize,
                             uint32_t moduleInstanceId, uint32_t dspParamId);
@@ -242,7 +222,7 @@ public:
     void payloadTWSConfig(uint8_t** payload, size_t* size, uint32_t miid,
                           bool isTwsMonoModeOn, uint32_t codecFormat);
     void payloadSPConfig(uint8_t** payload, size_t* size, uint32_t miid,
-                         int paramId, void *data);
+                         int paramId, void *data, PayloadArena *arena = nullptr);
     void payloadScramblingConfig(uint8_t** payload, size_t* size,
             uint32_t miid, uint32_t enable);
     int payloadPopSuppressorConfig(uint8_t** payload, size_t* size,
@@ -275,7 +255,11 @@ public:
     int populateCalKeyVector(Stream *s, std::vector <std::pair<int,int>> &ckv, int tag);
     int populateTagKeyVector(Stream *s, std::vector <std::pair<int,int>> &tkv, int tag, uint32_t* gsltag);
     void payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& module_payload, size_t *size, uint32_t moduleId);
+    void payloadTimestamp(PayloadArena &arena, uint8_t **payload, size_t *size, uint32_t moduleId);
     static int init();
+    static int loadKVCache(uint32_t xmlSize, uint32_t xmlChecksum);
+    static void storeKVCache(uint32_t xmlSize, uint32_t xmlChecksum);
+    static uint32_t kvCacheChecksum(const uint8_t *data, size_t size);
     static void endTag(void *userdata, const XML_Char *tag_name);
     static void startTag(void *userdata, const XML_Char *tag_name, const XML_Char **attr);
     static void handleData(void *userdata, const char *s, int len);
@@ -297,6 +281,7 @@ public:
     static bool findKVs(std::vector<std::pair<selector_type_t, std::string>>
         &filled_selector_pairs, uint32_t type, std::vector<allKVs> &any_type,
         std::vector<std::pair<int32_t, int32_t>> &keyVector);
+    static const kvTypeIndex *getKVIndex(const std::vector<allKVs> &any_type);
     static std::string removeSpaces(const std::string& str);
     static std::vector<std::string> splitStrings(const std::string& str);
     static int getBtDeviceKV(int dev_id, std::vector<std::pair<int, int>> &deviceKV,
@@ -46,6 +46,7 @@
 #include <errno.h>
 #include "PalCommon.h"
 #include "Device.h"
+#include "TimestampExtrapolator.h"
 
 
 
@@ -95,6 +96,11 @@ const std::map<std::uint32_t, slot_mask_t> slotMaskLUT {
 
 #define MSPP_SOFT_PAUSE_DELAY 150
 
+/* timestamp queries closer than this are extrapolated, not read from SPR */
+#define SESSION_TS_MIN_SAMPLE_US 20000
+/* DSP session/absolute time rates outside 1 +/- this are treated as stalls */
+#define SESSION_TS_MAX_DRIFT 0.005
+
 class Stream;
 class ResourceManager;
 class Session
@@ -111,6 +117,8 @@ protected:
     size_t customPayloadSize;
     int updateCustomPayload(void *payload, size_t size);
     int freeCustomPayload(uint8_t **payload, size_t *payloadSize);
+    /* reused for per-call payloads such as volume; released by the session */
+    PayloadArena payloadArena;
     uint32_t eventId;
     void *eventPayload;
     size_t eventPayloadSize;
@@ -121,6 +129,14 @@ protected:
     static int extECRefCnt;
     static std::mutex extECMutex;
     bool frontEndIdAllocated = false;
+    /* last SPR reading and the session clock model fed by it */
+    std::mutex tsMutex;
+    struct pal_session_time tsSample;
+    TimestampExtrapolator tsModel{SESSION_TS_MIN_SAMPLE_US, SESSION_TS_MAX_DRIFT};
+    static uint64_t tsClockUs();
+    int getCachedTimestamp(struct pal_session_time *stime);
+    void updateTimestampCache(struct pal_session_time *stime, uint64_t readStartUs);
+    void resetTimestampCache();
 public:
     bool isMixerEventCbRegd;
     bool isPauseRegistrationDone;
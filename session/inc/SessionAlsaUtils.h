@@ -36,6 +36,9 @@
 
 #include <tinyalsa/asoundlib.h>
 #include <sound/asound.h>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 
 class Stream;
@@ -83,8 +86,28 @@ private:
     static struct mixer_ctl *getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx);
     static struct mixer_ctl *getStaticMixerControl(struct mixer *am, std::string name);
+    static struct mixer_ctl *getCachedMixerControl(struct mixer *am,
+        const std::string &intfName, uint32_t ctlIdx, const char *ctlSuffix);
+    /* (mixer, FE/BE name, control index) -> resolved control */
+    static std::map<std::tuple<struct mixer *, std::string, uint32_t>,
+        struct mixer_ctl *> mixerCtlCache;
+    static std::mutex mixerCtlCacheMutex;
+    static uint64_t mixerCtlCacheHits;
+    static uint64_t mixerCtlCacheMisses;
+    /* (mixer, FE pcm id, BE name, tag) -> module instance id */
+    static std::map<std::tuple<struct mixer *, int, std::string, int>, uint32_t> miidCache;
+    static std::mutex miidCacheMutex;
+    static uint64_t miidCacheHits;
+    static uint64_t miidCacheMisses;
+    static int queryModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
+                       int tag_id, uint32_t *miid);
 public:
     ~SessionAlsaUtils();
+    static void invalidateMixerCtlCache();
+    static void getMixerCtlCacheStats(uint64_t *hits, uint64_t *misses);
+    static void invalidateMiidCache();
+    static void invalidateMiidCache(const std::vector<int> &devIds);
+    static void getMiidCacheStats(uint64_t *hits, uint64_t *misses);
     static bool isRxDevice(uint32_t devId);
     static int setMixerCtlData(struct mixer_ctl *ctl, MixerCtlType id, void *data, int size);
     static int getTagMetadata(int32_t tagsent, std::vector <std::pair<int, int>> &tkv, struct agm_tag_config *tagConfig);
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef TIMESTAMP_EXTRAPOLATOR_H
+#define TIMESTAMP_EXTRAPOLATOR_H
+
+#include <errno.h>
+#include <stdint.h>
+
+/*
+ * Session clock model behind the SPR timestamp cache. The session clock
+ * rate is measured only from the DSP's own (session time, absolute time)
+ * pairs, so host scheduling and ioctl latency do not leak into it. The
+ * host clock is used only to age the last reading and to advance it
+ * between reads. Kept free of PAL dependencies so it can be unit tested
+ * on the host with a simulated DSP clock.
+ */
+class TimestampExtrapolator {
+public:
+    TimestampExtrapolator(uint64_t maxAgeUs, double maxDrift);
+    void reset();
+    uint64_t update(uint64_t sessionUs, uint64_t absoluteUs, uint64_t hostUs);
+    int extrapolate(uint64_t hostUs, uint64_t *sessionUs, uint64_t *absoluteUs);
+    double rate() const { return rate_; }
+
+private:
+    uint64_t maxAgeUs_;
+    double maxDrift_;
+    bool valid_;
+    /* last DSP reading and the host time it was taken at */
+    uint64_t sessionUs_;
+    uint64_t absoluteUs_;
+    uint64_t hostUs_;
+    /* start of the DSP window the rate is measured over */
+    uint64_t refSessionUs_;
+    uint64_t refAbsoluteUs_;
+    uint64_t lastReportedUs_;
+    double rate_;
+};
+
+#endif // TIMESTAMP_EXTRAPOLATOR_H
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef USECASE_KV_INDEX_H_
+#define USECASE_KV_INDEX_H_
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef enum {
+    DIRECTION_SEL = 1,
+    BITWIDTH_SEL,
+    INSTANCE_SEL,
+    SUB_TYPE_SEL,
+    VSID_SEL,
+    VUI_MODULE_TYPE_SEL,
+    ACD_MODULE_TYPE_SEL,
+    STREAM_TYPE_SEL,
+    CODECFORMAT_SEL,
+    ABR_ENABLED_SEL,
+    AUD_FMT_SEL,
+    DEVICEPP_TYPE_SEL,
+    CUSTOM_CONFIG_SEL,
+    HOSTLESS_SEL,
+    SIDETONE_MODE_SEL,
+} selector_type_t;
+
+const std::map<std::string, selector_type_t> selectorstypeLUT {
+    {std::string{ "Direction" },             DIRECTION_SEL},
+    {std::string{ "BitWidth" },              BITWIDTH_SEL},
+    {std::string{ "Instance" },              INSTANCE_SEL},
+    {std::string{ "SubType" },               SUB_TYPE_SEL},
+    {std::string{ "VSID" },                  VSID_SEL},
+    {std::string{ "VUIModuleType" },         VUI_MODULE_TYPE_SEL},
+    {std::string{ "ACDModuleType" },         ACD_MODULE_TYPE_SEL},
+    {std::string{ "StreamType" },            STREAM_TYPE_SEL},
+    {std::string{ "DevicePPType" },          DEVICEPP_TYPE_SEL},
+    {std::string{ "CodecFormat" },           CODECFORMAT_SEL},
+    {std::string{ "AbrEnabled" },            ABR_ENABLED_SEL},
+    {std::string{ "AudioFormat" },           AUD_FMT_SEL},
+    {std::string{ "CustomConfig" },          CUSTOM_CONFIG_SEL},
+    {std::string{ "Hostless" },              HOSTLESS_SEL},
+    {std::string{ "SidetoneMode" },          SIDETONE_MODE_SEL},
+};
+
+struct kvPairs {
+    unsigned int key;
+    unsigned int value;
+};
+
+struct kvInfo {
+    std::vector<std::string> selector_names;
+    std::vector<std::pair<selector_type_t, std::string>> selector_pairs;
+    std::vector<kvPairs> kv_pairs;
+};
+
+struct allKVs {
+    std::vector<int> id_type;
+    std::vector<kvInfo> keys_values;
+};
+
+/* id type (stream type / device id) -> indices into an allKVs list */
+typedef std::unordered_map<int32_t, std::vector<uint32_t>> kvTypeIndex;
+
+/*
+ * Lookup of usecase KV entries parsed from usecaseKvManager.xml. The
+ * tables stay owned by PayloadBuilder; this only indexes and searches
+ * them, and has no PAL dependencies so it can be checked on the host.
+ */
+class UsecaseKvIndex {
+public:
+    static void build(std::vector<allKVs> &any_type, kvTypeIndex &index);
+    static bool find(std::vector<std::pair<selector_type_t, std::string>>
+        &filled_selector_pairs, int32_t type, std::vector<allKVs> &any_type,
+        const kvTypeIndex &index, std::vector<const struct kvInfo *> &matches);
+    static const std::vector<uint32_t> *getEntries(int32_t type,
+        const kvTypeIndex &index);
+};
+
+#endif //USECASE_KV_INDEX_H_
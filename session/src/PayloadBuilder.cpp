@@ -80,6 +80,10 @@
 #include "cps_data_router.h"
 #include "fluence_ffv_common_calibration.h"
 #include "mspp_module_calibration_api.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #if defined(FEATURE_IPQ_OPENWRT) || defined(LINUX_ENABLED)
 #define USECASE_XML_FILE "/etc/usecaseKvManager.xml"
@@ -87,6 +91,12 @@
 #define USECASE_XML_FILE "/vendor/etc/usecaseKvManager.xml"
 #endif
 
+#ifndef USECASE_KV_CACHE_FILE
+#define USECASE_KV_CACHE_FILE "/data/vendor/audio/usecaseKvManager.bin"
+#endif
+#define USECASE_KV_CACHE_MAGIC 0x43564b50 /* "PKVC" */
+#define USECASE_KV_CACHE_VERSION 1
+
 #define PARAM_ID_CHMIXER_COEFF 0x0800101F
 #define CUSTOM_STEREO_NUM_OUT_CH 0x0002
 #define CUSTOM_STEREO_NUM_IN_CH 0x0002
@@ -259,6 +269,46 @@ std::vector<allKVs> PayloadBuilder::all_streams;
 std::vector<allKVs> PayloadBuilder::all_streampps;
 std::vector<allKVs> PayloadBuilder::all_devices;
 std::vector<allKVs> PayloadBuilder::all_devicepps;
+kvTypeIndex PayloadBuilder::all_streams_index;
+kvTypeIndex PayloadBuilder::all_streampps_index;
+kvTypeIndex PayloadBuilder::all_devices_index;
+kvTypeIndex PayloadBuilder::all_devicepps_index;
+
+uint8_t* PayloadArena::alloc(size_t size)
+{
+    if (size <= sizeof(inlineBuf)) {
+        memset(inlineBuf, 0, size);
+        return (uint8_t *)inlineBuf;
+    }
+
+    if (size > heapSize) {
+        uint8_t *buf = (uint8_t *)realloc(heap, size);
+        if (!buf) {
+            PAL_ERR(LOG_TAG, "arena grow to %zu failed %s", size, strerror(errno));
+            return NULL;
+        }
+        heap = buf;
+        heapSize = size;
+    }
+    memset(heap, 0, size);
+    return heap;
+}
+
+bool PayloadArena::owns(const uint8_t *ptr) const
+{
+    return ptr && (ptr == (const uint8_t *)inlineBuf || ptr == heap);
+}
+
+/*
+ * Payloads built into an arena stay owned by it; without one the legacy
+ * contract holds and the caller frees the returned buffer.
+ */
+static inline uint8_t* allocPayload(PayloadArena *arena, size_t size)
+{
+    if (arena)
+        return arena->alloc(size);
+    return (uint8_t *)calloc(1, size);
+}
 
 template <typename T>
 void PayloadBuilder::populateChannelMixerCoeff(T pcmChannel, uint8_t numChannel,
@@ -432,7 +482,7 @@ void PayloadBuilder::payloadDpAudioConfig(uint8_t** payload, size_t* size,
 
 #define PLAYBACK_VOLUME_MAX 0x2000
 void PayloadBuilder::payloadVolumeConfig(uint8_t** payload, size_t* size,
-        uint32_t miid, struct pal_volume_data* voldata)
+        uint32_t miid, struct pal_volume_data* voldata, PayloadArena *arena)
 {
     struct apm_module_param_data_t* header = nullptr;
     volume_ctrl_master_gain_t *volConf = nullptr;
@@ -453,7 +503,7 @@ void PayloadBuilder::payloadVolumeConfig(uint8_t** payload, size_t* size,
     payloadSize = sizeof(struct apm_module_param_data_t) +
                   sizeof(struct volume_ctrl_master_gain_t);
     padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-    payloadInfo = new uint8_t[payloadSize + padBytes]();
+    payloadInfo = allocPayload(arena, payloadSize + padBytes);
     if (!payloadInfo) {
         PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
         return;
@@ -474,7 +524,7 @@ void PayloadBuilder::payloadVolumeConfig(uint8_t** payload, size_t* size,
 }
 
 void PayloadBuilder::payloadMultichVolumemConfig(uint8_t** payload, size_t* size,
-        uint32_t miid, struct pal_volume_data* voldata)
+        uint32_t miid, struct pal_volume_data* voldata, PayloadArena *arena)
 {
      const uint32_t PLAYBACK_MULTI_VOLUME_GAIN = 1 << 28;
      struct apm_module_param_data_t* header = nullptr;
@@ -488,7 +538,7 @@ void PayloadBuilder::payloadMultichVolumemConfig(uint8_t** payload, size_t* size
                    sizeof(struct volume_ctrl_multichannel_gain_t) +
                    numChannels * sizeof(volume_ctrl_channels_gain_config_t);
      padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-     payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+     payloadInfo = allocPayload(arena, payloadSize + padBytes);
      if (!payloadInfo) {
          PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
          return;
@@ -628,7 +678,7 @@ void PayloadBuilder::payloadMFCMixerCoeff(uint8_t** payload, size_t* size,
 }
 
 void PayloadBuilder::payloadMFCConfig(uint8_t** payload, size_t* size,
-        uint32_t miid, struct sessionToPayloadParam* data)
+        uint32_t miid, struct sessionToPayloadParam* data, PayloadArena *arena)
 {
     struct apm_module_param_data_t* header = NULL;
     struct param_id_mfc_output_media_fmt_t *mfcConf;
@@ -647,7 +697,7 @@ void PayloadBuilder::payloadMFCConfig(uint8_t** payload, size_t* size,
                   sizeof(uint16_t)*numChannels;
     padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-    payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+    payloadInfo = allocPayload(arena, payloadSize + padBytes);
     if (!payloadInfo) {
         PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
         return;
@@ -1080,13 +1130,256 @@ void PayloadBuilder::handleData(void *userdata, const char *s, int len)
    }
 }
 
+uint32_t PayloadBuilder::kvCacheChecksum(const uint8_t *data, size_t size)
+{
+    static uint32_t table[256];
+    static std::once_flag tableInit;
+    uint32_t crc = 0xFFFFFFFF;
+
+    std::call_once(tableInit, [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            table[i] = c;
+        }
+    });
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+/*
+ * Binary snapshot of the parsed usecase KV tables:
+ *   kvCacheHeader, then for each of all_streams, all_streampps,
+ *   all_devices, all_devicepps:
+ *     u32 blocks, per block: u32 ids + ids, u32 entries, per entry:
+ *       u32 names + (u32 len, bytes), u32 selectors + (u32 type, u32 len, bytes),
+ *       u32 kvs + (u32 key, u32 value)
+ * The header carries size and checksum of the source XML, so any change
+ * to the XML invalidates the snapshot.
+ */
+struct kvCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t xmlSize;
+    uint32_t xmlChecksum;
+    uint32_t payloadSize;
+    uint32_t payloadChecksum;
+};
+
+static void kvCachePut(std::vector<uint8_t> &out, uint32_t val)
+{
+    out.insert(out.end(), (uint8_t *)&val, (uint8_t *)&val + sizeof(val));
+}
+
+static void kvCachePut(std::vector<uint8_t> &out, const std::string &str)
+{
+    kvCachePut(out, (uint32_t)str.size());
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+static bool kvCacheGet(const uint8_t *&cur, const uint8_t *end, uint32_t &val)
+{
+    if (end - cur < (ptrdiff_t)sizeof(val))
+        return false;
+    memcpy(&val, cur, sizeof(val));
+    cur += sizeof(val);
+    return true;
+}
+
+static bool kvCacheGet(const uint8_t *&cur, const uint8_t *end, std::string &str)
+{
+    uint32_t len = 0;
+
+    if (!kvCacheGet(cur, end, len) || end - cur < (ptrdiff_t)len)
+        return false;
+    str.assign((const char *)cur, len);
+    cur += len;
+    return true;
+}
+
+static bool kvCacheGetList(const uint8_t *&cur, const uint8_t *end,
+    std::vector<allKVs> &list)
+{
+    uint32_t blocks = 0, count = 0, val = 0;
+
+    if (!kvCacheGet(cur, end, blocks))
+        return false;
+    list.resize(blocks);
+    for (auto &block : list) {
+        if (!kvCacheGet(cur, end, count))
+            return false;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!kvCacheGet(cur, end, val))
+                return false;
+            block.id_type.push_back((int)val);
+        }
+        if (!kvCacheGet(cur, end, count))
+            return false;
+        block.keys_values.resize(count);
+        for (auto &info : block.keys_values) {
+            if (!kvCacheGet(cur, end, count))
+                return false;
+            info.selector_names.resize(count);
+            for (auto &name : info.selector_names) {
+                if (!kvCacheGet(cur, end, name))
+                    return false;
+            }
+            if (!kvCacheGet(cur, end, count))
+                return false;
+            info.selector_pairs.resize(count);
+            for (auto &pair : info.selector_pairs) {
+                if (!kvCacheGet(cur, end, val) || !kvCacheGet(cur, end, pair.second))
+                    return false;
+                pair.first = (selector_type_t)val;
+            }
+            if (!kvCacheGet(cur, end, count))
+                return false;
+            info.kv_pairs.resize(count);
+            for (auto &kv : info.kv_pairs) {
+                if (!kvCacheGet(cur, end, kv.key) || !kvCacheGet(cur, end, kv.value))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void kvCachePutList(std::vector<uint8_t> &out, const std::vector<allKVs> &list)
+{
+    kvCachePut(out, (uint32_t)list.size());
+    for (auto &block : list) {
+        kvCachePut(out, (uint32_t)block.id_type.size());
+        for (int id : block.id_type)
+            kvCachePut(out, (uint32_t)id);
+        kvCachePut(out, (uint32_t)block.keys_values.size());
+        for (auto &info : block.keys_values) {
+            kvCachePut(out, (uint32_t)info.selector_names.size());
+            for (auto &name : info.selector_names)
+                kvCachePut(out, name);
+            kvCachePut(out, (uint32_t)info.selector_pairs.size());
+            for (auto &pair : info.selector_pairs) {
+                kvCachePut(out, (uint32_t)pair.first);
+                kvCachePut(out, pair.second);
+            }
+            kvCachePut(out, (uint32_t)info.kv_pairs.size());
+            for (auto &kv : info.kv_pairs) {
+                kvCachePut(out, kv.key);
+                kvCachePut(out, kv.value);
+            }
+        }
+    }
+}
+
+int PayloadBuilder::loadKVCache(uint32_t xmlSize, uint32_t xmlChecksum)
+{
+    int ret = 0;
+    int fd = -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+    struct kvCacheHeader hdr;
+    const uint8_t *cur = NULL, *end = NULL;
+
+    fd = open(USECASE_KV_CACHE_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        PAL_INFO(LOG_TAG, "no KV cache at %s", USECASE_KV_CACHE_FILE);
+        return -ENOENT;
+    }
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(hdr)) {
+        ret = -EINVAL;
+        goto closeFd;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        PAL_ERR(LOG_TAG, "mmap of KV cache failed %s", strerror(errno));
+        ret = -errno;
+        goto closeFd;
+    }
+
+    memcpy(&hdr, map, sizeof(hdr));
+    if (hdr.magic != USECASE_KV_CACHE_MAGIC ||
+        hdr.version != USECASE_KV_CACHE_VERSION ||
+        hdr.xmlSize != xmlSize || hdr.xmlChecksum != xmlChecksum ||
+        (off_t)hdr.payloadSize != st.st_size - (off_t)sizeof(hdr)) {
+        PAL_INFO(LOG_TAG, "KV cache is stale, reparsing %s", USECASE_XML_FILE);
+        ret = -ESTALE;
+        goto unmap;
+    }
+    cur = (const uint8_t *)map + sizeof(hdr);
+    end = cur + hdr.payloadSize;
+    if (kvCacheChecksum(cur, hdr.payloadSize) != hdr.payloadChecksum) {
+        PAL_ERR(LOG_TAG, "KV cache checksum mismatch");
+        ret = -EINVAL;
+        goto unmap;
+    }
+
+    if (!kvCacheGetList(cur, end, all_streams) ||
+        !kvCacheGetList(cur, end, all_streampps) ||
+        !kvCacheGetList(cur, end, all_devices) ||
+        !kvCacheGetList(cur, end, all_devicepps) || cur != end) {
+        PAL_ERR(LOG_TAG, "KV cache is truncated or malformed");
+        all_streams.clear();
+        all_streampps.clear();
+        all_devices.clear();
+        all_devicepps.clear();
+        ret = -EINVAL;
+    }
+
+unmap:
+    munmap(map, st.st_size);
+closeFd:
+    close(fd);
+    return ret;
+}
+
+void PayloadBuilder::storeKVCache(uint32_t xmlSize, uint32_t xmlChecksum)
+{
+    std::vector<uint8_t> out;
+    struct kvCacheHeader hdr;
+    std::string tmpFile = std::string(USECASE_KV_CACHE_FILE) + ".tmp";
+    FILE *file = NULL;
+    bool ok = false;
+
+    out.resize(sizeof(hdr));
+    kvCachePutList(out, all_streams);
+    kvCachePutList(out, all_streampps);
+    kvCachePutList(out, all_devices);
+    kvCachePutList(out, all_devicepps);
+
+    hdr.magic = USECASE_KV_CACHE_MAGIC;
+    hdr.version = USECASE_KV_CACHE_VERSION;
+    hdr.xmlSize = xmlSize;
+    hdr.xmlChecksum = xmlChecksum;
+    hdr.payloadSize = out.size() - sizeof(hdr);
+    hdr.payloadChecksum = kvCacheChecksum(out.data() + sizeof(hdr), hdr.payloadSize);
+    memcpy(out.data(), &hdr, sizeof(hdr));
+
+    /* write aside and rename so a reader never sees a partial snapshot */
+    file = fopen(tmpFile.c_str(), "wb");
+    if (!file) {
+        PAL_INFO(LOG_TAG, "cannot create KV cache %s: %s", tmpFile.c_str(),
+            strerror(errno));
+        return;
+    }
+    ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmpFile.c_str(), USECASE_KV_CACHE_FILE)) {
+        PAL_ERR(LOG_TAG, "failed to write KV cache %s", USECASE_KV_CACHE_FILE);
+        unlink(tmpFile.c_str());
+        return;
+    }
+    PAL_INFO(LOG_TAG, "KV cache written, %zu bytes", out.size());
+}
+
 int PayloadBuilder::init()
 {
     XML_Parser parser;
     FILE *file = NULL;
     int ret = 0;
-    int bytes_read;
-    void *buf = NULL;
+    long fileSize = 0;
+    uint32_t xmlChecksum = 0;
+    std::vector<uint8_t> xml;
     struct user_xml_data tag_data;
     memset(&tag_data, 0, sizeof(tag_data));
     all_streams.clear();
@@ -1102,6 +1395,26 @@ int PayloadBuilder::init()
         goto done;
     }
 
+    /* Read the whole file once: it feeds both the cache check and expat */
+    if (fseek(file, 0, SEEK_END) || (fileSize = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET)) {
+        PAL_ERR(LOG_TAG, "Failed to get xml size");
+        ret = -EINVAL;
+        goto closeFile;
+    }
+    xml.resize(fileSize);
+    if (fread(xml.data(), 1, fileSize, file) != (size_t)fileSize) {
+        PAL_ERR(LOG_TAG, "fread failed");
+        ret = -EINVAL;
+        goto closeFile;
+    }
+    xmlChecksum = kvCacheChecksum(xml.data(), xml.size());
+
+    if (loadKVCache((uint32_t)fileSize, xmlChecksum) == 0) {
+        PAL_INFO(LOG_TAG, "KV tables loaded from %s", USECASE_KV_CACHE_FILE);
+        goto buildIndex;
+    }
+
     parser = XML_ParserCreate(NULL);
     if (!parser) {
         PAL_ERR(LOG_TAG, "Failed to create XML");
@@ -1111,32 +1424,24 @@ int PayloadBuilder::init()
     XML_SetElementHandler(parser, startTag, endTag);
     XML_SetCharacterDataHandler(parser, handleData);
 
-    while (1) {
-        buf = XML_GetBuffer(parser, 1024);
-        if (buf == NULL) {
-            PAL_ERR(LOG_TAG, "XML_Getbuffer failed");
-            ret = -EINVAL;
-            goto freeParser;
-        }
-
-        bytes_read = fread(buf, 1, 1024, file);
-        if (bytes_read < 0) {
-            PAL_ERR(LOG_TAG, "fread failed");
-            ret = -EINVAL;
-            goto freeParser;
-        }
-
-        if (XML_ParseBuffer(parser, bytes_read, bytes_read == 0) == XML_STATUS_ERROR) {
-            PAL_ERR(LOG_TAG, "XML ParseBuffer failed ");
-            ret = -EINVAL;
-            goto freeParser;
-        }
-        if (bytes_read == 0)
-            break;
+    if (XML_Parse(parser, (const char *)xml.data(), xml.size(), 1) == XML_STATUS_ERROR) {
+        PAL_ERR(LOG_TAG, "XML ParseBuffer failed ");
+        ret = -EINVAL;
+        XML_ParserFree(parser);
+        goto closeFile;
     }
-
-freeParser:
     XML_ParserFree(parser);
+    storeKVCache((uint32_t)fileSize, xmlChecksum);
+
+buildIndex:
+    UsecaseKvIndex::build(all_streams, all_streams_index);
+    UsecaseKvIndex::build(all_streampps, all_streampps_index);
+    UsecaseKvIndex::build(all_devices, all_devices_index);
+    UsecaseKvIndex::build(all_devicepps, all_devicepps_index);
+    PAL_INFO(LOG_TAG, "KV index built: %zu stream, %zu streampp, %zu device, %zu devicepp types",
+        all_streams_index.size(), all_streampps_index.size(),
+        all_devices_index.size(), all_devicepps_index.size());
+
 closeFile:
     fclose(file);
 done:
@@ -1168,6 +1473,30 @@ void PayloadBuilder::payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& pay
     PAL_DBG(LOG_TAG, "payload %pK size %zu", payload->data(), *size);
 }
 
+void PayloadBuilder::payloadTimestamp(PayloadArena &arena, uint8_t **payload,
+                                      size_t *size, uint32_t moduleId)
+{
+    size_t payloadSize, padBytes;
+    struct apm_module_param_data_t* header;
+    uint8_t *payloadInfo = NULL;
+
+    payloadSize = sizeof(struct apm_module_param_data_t) +
+                  sizeof(struct param_id_spr_session_time_t);
+    padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
+    payloadInfo = arena.alloc(payloadSize + padBytes);
+    if (!payloadInfo) {
+        PAL_ERR(LOG_TAG, "payload alloc failed");
+        return;
+    }
+    header = (struct apm_module_param_data_t*)payloadInfo;
+    header->module_instance_id = moduleId;
+    header->param_id = PARAM_ID_SPR_SESSION_TIME;
+    header->error_code = 0x0;
+    header->param_size = payloadSize -  sizeof(struct apm_module_param_data_t);
+    *size = payloadSize + padBytes;
+    *payload = payloadInfo;
+}
+
 int PayloadBuilder::payloadACDBTunnelParam(uint8_t **alsaPayload,
             size_t *size, uint8_t *payload,
             const std::set <std::pair<int, int>> &acdbGKVSet,
@@ -2472,47 +2801,41 @@ exit:
     return result;
 }
 
+const kvTypeIndex *PayloadBuilder::getKVIndex(const std::vector<allKVs> &any_type)
+{
+    if (&any_type == &all_streams)
+        return &all_streams_index;
+    else if (&any_type == &all_streampps)
+        return &all_streampps_index;
+    else if (&any_type == &all_devices)
+        return &all_devices_index;
+    else if (&any_type == &all_devicepps)
+        return &all_devicepps_index;
+
+    PAL_ERR(LOG_TAG, "no KV index for list %pK", &any_type);
+    return nullptr;
+}
+
 bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>>
     &filled_selector_pairs, uint32_t type, std::vector<allKVs> &any_type,
     std::vector<std::pair<int, int>> &keyVector)
 {
-    bool found = false;
-
-    for (int32_t i = 0; i < any_type.size(); i++) {
-        if (isIdTypeAvailable(type, any_type[i].id_type)) {
-            for (int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
-                if (filled_selector_pairs.empty() != true) {
-                    if (compareSelectorPairs(any_type[i].keys_values[j].selector_pairs,
-                           filled_selector_pairs)) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
-                } else {
-                    if (any_type[i].keys_values[j].selector_pairs.empty()) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
-                }
-            }
+    const kvTypeIndex *index = getKVIndex(any_type);
+    std::vector<const struct kvInfo *> matches;
+
+    if (!index || !UsecaseKvIndex::find(filled_selector_pairs, type, any_type,
+            *index, matches))
+        return false;
+
+    for (auto match : matches) {
+        for (int32_t k = 0; k < match->kv_pairs.size(); k++) {
+            keyVector.push_back(std::make_pair(match->kv_pairs[k].key,
+                match->kv_pairs[k].value));
+            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
+                match->kv_pairs[k].key, match->kv_pairs[k].value);
         }
     }
-    return found;
+    return true;
 }
 
 int PayloadBuilder::retrieveKVs(std::vector<std::pair<selector_type_t, std::string>>
@@ -2733,18 +3056,21 @@ bool PayloadBuilder::isIdTypeAvailable(int32_t type, std::vector<int>& id_type)
 std::vector<std::string> PayloadBuilder::retrieveSelectors(int32_t type, std::vector<allKVs> &any_type)
 {
     std::vector<std::string> gkv_selectors;
+    const kvTypeIndex *index = getKVIndex(any_type);
+    const std::vector<uint32_t> *entries =
+        index ? UsecaseKvIndex::getEntries(type, *index) : nullptr;
     PAL_DBG(LOG_TAG, "Enter: size_of_all :%zu type:%d", any_type.size(), type);
 
     /* looping for all keys_and_values selectors and store in the gkv_selectors */
-    for (int32_t i = 0; i < any_type.size(); i++) {
-         if (isIdTypeAvailable(type, any_type[i].id_type)) {
+    if (entries) {
+        for (uint32_t i : *entries) {
              PAL_DBG(LOG_TAG, "KeysAndValues_size: %zu", any_type[i].keys_values.size());
              for(int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
                  for(int32_t k = 0; k < any_type[i].keys_values[j].selector_names.size(); k++) {
                      gkv_selectors.push_back(any_type[i].keys_values[j].selector_names[k]);
                  }
              }
-         }
+        }
     }
 
     if (gkv_selectors.size())
@@ -3688,7 +4014,7 @@ int PayloadBuilder::populateTagKeyVector(Stream *s, std::vector <std::pair<int,i
 }
 
 void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t miid,
-                int param_id, void *param)
+                int param_id, void *param, PayloadArena *arena)
 {
     struct apm_module_param_data_t* header = NULL;
     uint8_t* payloadInfo = NULL;
@@ -3713,7 +4039,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                               sizeof(vi_r0t0_cfg_t) * data->num_ch;
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3746,7 +4072,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                               sizeof(uint32_t) * data->num_speakers;
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3788,7 +4114,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3816,7 +4142,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3840,7 +4166,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3868,7 +4194,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                                     sizeof(vi_th_ftm_cfg_t) * data->num_ch;
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3897,7 +4223,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                                     sizeof(param_id_sp_th_vi_ftm_params_t) +
                                     sizeof(vi_th_ftm_params_t) * data->num_ch;
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3913,7 +4239,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                                     sizeof(param_id_sp_ex_vi_ftm_params_t) +
                                     sizeof(vi_ex_ftm_params_t) * data->num_ch;
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3933,7 +4259,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                                     sizeof(uint32_t);
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3960,7 +4286,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                                     (sizeof(cps_reg_wr_values_t) * data->num_spkr);
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -3987,7 +4313,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
 
                 padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
 
-                payloadInfo = (uint8_t*) calloc(1, payloadSize + padBytes);
+                payloadInfo = allocPayload(arena, payloadSize + padBytes);
                 if (!payloadInfo) {
                     PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                     return;
@@ -4015,7 +4341,7 @@ void PayloadBuilder::payloadSPConfig(uint8_t** payload, size_t* size, uint32_t m
                 sizeof(param_id_sp_tmax_xmax_logging_t) + (sizeof(sp_tmax_xmax_params_t) * data->num_ch);
 
             padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
-            payloadInfo = (uint8_t*)calloc(1, payloadSize + padBytes);
+            payloadInfo = allocPayload(arena, payloadSize + padBytes);
             if (!payloadInfo) {
                 PAL_ERR(LOG_TAG, "payloadInfo malloc failed %s", strerror(errno));
                 return;
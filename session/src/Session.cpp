@@ -97,6 +97,71 @@ Session::~Session()
 
 }
 
+static inline uint64_t palTimeToUs(const struct pal_time_us *t)
+{
+    return ((uint64_t)t->value_msw << 32) | t->value_lsw;
+}
+
+static inline void usToPalTime(uint64_t us, struct pal_time_us *t)
+{
+    t->value_lsw = (uint32_t)us;
+    t->value_msw = (uint32_t)(us >> 32);
+}
+
+uint64_t Session::tsClockUs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * Serve a timestamp query from the last SPR reading when it is recent and
+ * the session clock rate is known. Returns -EAGAIN when the caller has to
+ * read the DSP and call updateTimestampCache().
+ */
+int Session::getCachedTimestamp(struct pal_session_time *stime)
+{
+    std::lock_guard<std::mutex> lock(tsMutex);
+    uint64_t sessionUs = 0, absoluteUs = 0;
+    int status = 0;
+
+    status = tsModel.extrapolate(tsClockUs(), &sessionUs, &absoluteUs);
+    if (status)
+        return status;
+
+    *stime = tsSample;
+    usToPalTime(sessionUs, &stime->session_time);
+    usToPalTime(absoluteUs, &stime->absolute_time);
+
+    return 0;
+}
+
+/*
+ * readStartUs is tsClockUs() from before the SPR read; the reading is
+ * pinned to the middle of the round trip.
+ */
+void Session::updateTimestampCache(struct pal_session_time *stime, uint64_t readStartUs)
+{
+    std::lock_guard<std::mutex> lock(tsMutex);
+    uint64_t now = tsClockUs();
+    uint64_t sessionUs = 0;
+
+    sessionUs = tsModel.update(palTimeToUs(&stime->session_time),
+                               palTimeToUs(&stime->absolute_time),
+                               readStartUs + (now - readStartUs) / 2);
+    usToPalTime(sessionUs, &stime->session_time);
+    tsSample = *stime;
+}
+
+void Session::resetTimestampCache()
+{
+    std::lock_guard<std::mutex> lock(tsMutex);
+
+    tsModel.reset();
+}
+
 void Session::setPmQosMixerCtl(pmQosVote vote)
 {
     struct mixer *hwMixer;
@@ -632,7 +697,8 @@ int Session::getCustomPayload(uint8_t **payload, size_t *payloadSize)
 int Session::freeCustomPayload(uint8_t **payload, size_t *payloadSize)
 {
     if (*payload) {
-        free(*payload);
+        if (!payloadArena.owns(*payload))
+            free(*payload);
         *payload = NULL;
         *payloadSize = 0;
     }
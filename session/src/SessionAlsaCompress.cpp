@@ -1157,6 +1157,8 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
     int ckv_size = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
+    if (tag == PAUSE_TAG || tag == RESUME_TAG)
+        resetTimestampCache();
     status = s->getStreamAttributes(&sAttr);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -1348,6 +1350,7 @@ int SessionAlsaCompress::start(Stream * s)
     memset(&streamData, 0, sizeof(struct sessionToPayloadParam));
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
 
     memset(&dAttr, 0, sizeof(struct pal_device));
     rm->voteSleepMonitor(s, true);
@@ -1691,6 +1694,7 @@ int SessionAlsaCompress::pause(Stream * s)
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
 
     if (compress && playback_started) {
         status = compress_pause(compress);
@@ -1706,6 +1710,7 @@ int SessionAlsaCompress::resume(Stream * s __unused)
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
 
     if (compress && playback_paused) {
         status = compress_resume(compress);
@@ -1724,6 +1729,7 @@ int SessionAlsaCompress::stop(Stream * s __unused)
     struct pal_stream_attributes sAttr;
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
 
     status = s->getStreamAttributes(&sAttr);
     if (status != 0) {
@@ -2209,9 +2215,11 @@ int SessionAlsaCompress::setParameters(Stream *s __unused, int tagId, uint32_t p
             }
 
             if (vdata->no_of_volpair == 2 && sAttr.out_media_config.ch_info.channels == 2) {
-                builder->payloadMultichVolumemConfig(&alsaParamData, &alsaPayloadSize, miid, vdata);
+                builder->payloadMultichVolumemConfig(&alsaParamData, &alsaPayloadSize, miid,
+                                                     vdata, &payloadArena);
             } else {
-                builder->payloadVolumeConfig(&alsaParamData, &alsaPayloadSize, miid, vdata);
+                builder->payloadVolumeConfig(&alsaParamData, &alsaPayloadSize, miid,
+                                             vdata, &payloadArena);
             }
 
             if (alsaPayloadSize) {
@@ -2294,6 +2302,7 @@ int SessionAlsaCompress::flush()
 {
     int status = 0;
     PAL_VERBOSE(LOG_TAG, "Enter flush");
+    resetTimestampCache();
 
     if (playback_started) {
         if (compressDevIds.size() > 0) {
@@ -2354,11 +2363,17 @@ int SessionAlsaCompress::getParameters(Stream *s __unused, int tagId __unused, u
 int SessionAlsaCompress::getTimestamp(struct pal_session_time *stime)
 {
     int status = 0;
+    uint64_t readStartUs = 0;
+
+    if (getCachedTimestamp(stime) == 0)
+        return 0;
+    readStartUs = tsClockUs();
     status = SessionAlsaUtils::getTimestamp(mixer, compressDevIds, spr_miid, stime);
     if (0 != status) {
        PAL_ERR(LOG_TAG, "getTimestamp failed status = %d", status);
        return status;
     }
+    updateTimestampCache(stime, readStartUs);
     return status;
 }
 
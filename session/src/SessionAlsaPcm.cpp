@@ -519,6 +519,9 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
     int tag_config_size = 0;
     int cal_config_size = 0;
 
+    if (tag == PAUSE_TAG || tag == RESUME_TAG)
+        resetTimestampCache();
+
     status = s->getStreamAttributes(&sAttr);
     if (status != 0) {
         PAL_ERR(LOG_TAG, "stream get attributes failed");
@@ -866,6 +869,7 @@ int SessionAlsaPcm::start(Stream * s)
     uint8_t *volPayload = nullptr;
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
 
     memset(&dAttr, 0, sizeof(struct pal_device));
     rm->voteSleepMonitor(s, true);
@@ -1708,6 +1712,7 @@ int SessionAlsaPcm::stop(Stream * s)
     int DeviceId;
 
     PAL_DBG(LOG_TAG, "Enter");
+    resetTimestampCache();
     status = s->getStreamAttributes(&sAttr);
     if (status != 0) {
         PAL_ERR(LOG_TAG, "stream get attributes failed");
@@ -2575,9 +2580,11 @@ int SessionAlsaPcm::setParameters(Stream *streamHandle, int tagId, uint32_t para
             }
 
             if (vdata->no_of_volpair == 2 && sAttr.out_media_config.ch_info.channels == 2) {
-                builder->payloadMultichVolumemConfig(&paramData, &paramSize, miid, vdata);
+                builder->payloadMultichVolumemConfig(&paramData, &paramSize, miid, vdata,
+                                                     &payloadArena);
             } else {
-                builder->payloadVolumeConfig(&paramData, &paramSize, miid, vdata);
+                builder->payloadVolumeConfig(&paramData, &paramSize, miid, vdata,
+                                             &payloadArena);
             }
 
             if (paramSize) {
@@ -3155,6 +3162,7 @@ int SessionAlsaPcm::registerCallBack(session_callback cb, uint64_t cookie)
 int SessionAlsaPcm::getTimestamp(struct pal_session_time *stime)
 {
     int status = 0;
+    uint64_t readStartUs = 0;
 
     if (pcmDevIds.size() == 0) {
         PAL_ERR(LOG_TAG, "frontendIDs is not available.");
@@ -3171,9 +3179,14 @@ int SessionAlsaPcm::getTimestamp(struct pal_session_time *stime)
             return status;
         }
     }
+    if (getCachedTimestamp(stime) == 0)
+        return 0;
+    readStartUs = tsClockUs();
     status = SessionAlsaUtils::getTimestamp(mixer, pcmDevIds, spr_miid, stime);
     if (0 != status)
        PAL_ERR(LOG_TAG, "getTimestamp failed status = %d", status);
+    else
+       updateTimestampCache(stime, readStartUs);
 
     return status;
 }
@@ -3187,6 +3200,7 @@ int SessionAlsaPcm::flush()
 {
     int status = 0;
     PAL_VERBOSE(LOG_TAG, "Enter flush");
+    resetTimestampCache();
 
     if (pcmDevIds.size() > 0) {
         status = SessionAlsaUtils::flush(rm, pcmDevIds.at(0));
@@ -68,6 +68,7 @@
 
 #include <sstream>
 #include <string>
+#include <chrono>
 #include <set>
 //#include "SessionAlsa.h"
 //#include "SessionAlsaPcm.h"
@@ -336,17 +337,73 @@ struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std:
     return mixer_get_ctl_by_name(am, cntrlName.str().data());
 }
 
-struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::string feName,
-        uint32_t idx)
+/* BE controls share the cache with FE ones, so offset their indices */
+#define BE_CTL_CACHE_IDX(idx) (FE_MAX_NUM_MIXER_CONTROLS + (idx))
+
+std::map<std::tuple<struct mixer *, std::string, uint32_t>, struct mixer_ctl *>
+    SessionAlsaUtils::mixerCtlCache;
+std::mutex SessionAlsaUtils::mixerCtlCacheMutex;
+uint64_t SessionAlsaUtils::mixerCtlCacheHits = 0;
+uint64_t SessionAlsaUtils::mixerCtlCacheMisses = 0;
+
+/*
+ * mixer_get_ctl_by_name() walks every control of the card, and FE/BE
+ * controls are looked up many times per stream open and device switch.
+ * Resolved controls are remembered until the mixer goes away (SSR/deinit).
+ */
+struct mixer_ctl *SessionAlsaUtils::getCachedMixerControl(struct mixer *am,
+        const std::string &intfName, uint32_t ctlIdx, const char *ctlSuffix)
 {
     std::ostringstream cntrlName;
     struct mixer_ctl *ctl = NULL;
+    std::lock_guard<std::mutex> lock(mixerCtlCacheMutex);
+    auto key = std::make_tuple(am, intfName, ctlIdx);
+    auto it = mixerCtlCache.find(key);
 
-    cntrlName << feName << feCtrlNames[idx];
+    if (it != mixerCtlCache.end()) {
+        mixerCtlCacheHits++;
+        return it->second;
+    }
+
+    mixerCtlCacheMisses++;
+    cntrlName << intfName << ctlSuffix;
     PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
     ctl = mixer_get_ctl_by_name(am, cntrlName.str().data());
+    if (ctl)
+        mixerCtlCache.emplace(key, ctl);
+
+    return ctl;
+}
+
+void SessionAlsaUtils::invalidateMixerCtlCache()
+{
+    std::lock_guard<std::mutex> lock(mixerCtlCacheMutex);
+
+    PAL_INFO(LOG_TAG, "dropping %zu cached mixer controls, hits %llu misses %llu",
+             mixerCtlCache.size(), (unsigned long long)mixerCtlCacheHits,
+             (unsigned long long)mixerCtlCacheMisses);
+    mixerCtlCache.clear();
+}
+
+void SessionAlsaUtils::getMixerCtlCacheStats(uint64_t *hits, uint64_t *misses)
+{
+    std::lock_guard<std::mutex> lock(mixerCtlCacheMutex);
+
+    if (hits)
+        *hits = mixerCtlCacheHits;
+    if (misses)
+        *misses = mixerCtlCacheMisses;
+}
+
+struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::string feName,
+        uint32_t idx)
+{
+    struct mixer_ctl *ctl = NULL;
+
+    ctl = getCachedMixerControl(am, feName, idx, feCtrlNames[idx]);
     if (!ctl)
-        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
+        PAL_FATAL(LOG_TAG, "invalid mixer control: %s%s", feName.c_str(),
+                  feCtrlNames[idx]);
 
     return ctl;
 }
@@ -354,16 +411,13 @@ struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::str
 struct mixer_ctl *SessionAlsaUtils::getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
-
-    cntrlName << beName << beCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    return getCachedMixerControl(am, beName, BE_CTL_CACHE_IDX(idx), beCtrlNames[idx]);
 }
 
 int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
     const std::vector<int> &DevIds, const std::vector<std::pair<int32_t, std::string>> &BackEnds)
 {
+    invalidateMiidCache(DevIds);
     std::vector <std::pair<int, int>> streamKV;
     std::vector <std::pair<int, int>> streamCKV;
     std::vector <std::pair<int, int>> streamDeviceKV;
@@ -389,6 +443,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
     struct pal_device_info devinfo = {};
     struct pal_device dAttr;
     PayloadBuilder* builder = nullptr;
+    auto openStart = std::chrono::steady_clock::now();
 
     PAL_DBG(LOG_TAG, "Entry \n");
 
@@ -574,7 +629,11 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
             goto freeMetaData;
         }
 
-        /** set mixer controls */
+        /*
+         * set mixer controls, one write each: AGM has no batched control
+         * and takes FE metadata relative to the backend selected in
+         * FE_CONTROL, so these cannot be merged or reordered.
+         */
         if (deviceMetaData.size)
             mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                     deviceMetaData.size);
@@ -607,7 +666,9 @@ exit:
        delete builder;
        builder = NULL;
     }
-    PAL_DBG(LOG_TAG, "Exit, status %d", status);
+    PAL_DBG(LOG_TAG, "Exit, status %d, took %lld us", status,
+            (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - openStart).count());
     return status;
 }
 
@@ -615,6 +676,7 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     const std::vector<int> &DevIds, const std::vector<std::pair<int32_t, std::string>> &BackEnds,
     std::vector<std::pair<std::string, int>> &freedevicemetadata)
 {
+    invalidateMiidCache(DevIds);
     int status = 0;
     uint32_t i;
     std::vector <std::pair<int, int>> emptyKV;
@@ -1061,7 +1123,9 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
     std::ostringstream CntrlName;
     struct mixer_ctl *ctl;
     struct param_id_spr_session_time_t *spr_session_time;
-    std::shared_ptr<std::vector<uint8_t>> payload = nullptr;
+    PayloadArena arena;
+    PayloadBuilder builder;
+    uint8_t *payload = NULL;
     size_t payloadSize = 0;
     std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
 
@@ -1083,26 +1147,26 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
         return -ENOENT;
     }
 
-    PayloadBuilder* builder = new PayloadBuilder();
-    builder->payloadTimestamp(payload, &payloadSize, spr_miid);
+    /* payload fits the arena's inline storage, so polling never allocates */
+    builder.payloadTimestamp(arena, &payload, &payloadSize, spr_miid);
     if (!payload) {
         PAL_ERR(LOG_TAG, "Timestamp payload formation failed");
         status = -EINVAL;
         goto exit;
     }
-    status = mixer_ctl_set_array(ctl, payload->data(), payloadSize);
+    status = mixer_ctl_set_array(ctl, payload, payloadSize);
     if (0 != status) {
          PAL_ERR(LOG_TAG, "Set failed status = %d", status);
          goto exit;
     }
-    memset(payload->data(), 0, payloadSize);
-    status = mixer_ctl_get_array(ctl, payload->data(), payloadSize);
+    memset(payload, 0, payloadSize);
+    status = mixer_ctl_get_array(ctl, payload, payloadSize);
     if (0 != status) {
          PAL_ERR(LOG_TAG, "Get failed status = %d", status);
          goto exit;
     }
     spr_session_time = (struct param_id_spr_session_time_t *)
-                     (payload->data() + sizeof(struct apm_module_param_data_t));
+                     (payload + sizeof(struct apm_module_param_data_t));
     stime->session_time.value_lsw = spr_session_time->session_time.value_lsw;
     stime->session_time.value_msw = spr_session_time->session_time.value_msw;
     stime->absolute_time.value_lsw = spr_session_time->absolute_time.value_lsw;
@@ -1111,15 +1175,84 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
     stime->timestamp.value_msw = spr_session_time->timestamp.value_msw;
     //flags from Spf are igonred
 exit:
-    if(builder) {
-       delete builder;
-       builder = NULL;
-    }
     return status;
 }
 
+std::map<std::tuple<struct mixer *, int, std::string, int>, uint32_t>
+    SessionAlsaUtils::miidCache;
+std::mutex SessionAlsaUtils::miidCacheMutex;
+uint64_t SessionAlsaUtils::miidCacheHits = 0;
+uint64_t SessionAlsaUtils::miidCacheMisses = 0;
+
+/*
+ * MIIDs only change when the graph behind a FE is rebuilt, so they are
+ * remembered per (FE, BE, tag) and dropped on open/close, device
+ * connect/disconnect of that FE and on SSR. This turns repeated
+ * setParam (e.g. volume ramps) into a single mixer write instead of a
+ * metadata write plus a getTaggedInfo round trip each time.
+ */
 int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
                        int tag_id, uint32_t *miid)
+{
+    int ret = 0;
+
+    if (!intf_name || !miid)
+        return -EINVAL;
+
+    auto key = std::make_tuple(mixer, device, std::string(intf_name), tag_id);
+    {
+        std::lock_guard<std::mutex> lock(miidCacheMutex);
+        auto it = miidCache.find(key);
+        if (it != miidCache.end()) {
+            miidCacheHits++;
+            *miid = it->second;
+            return 0;
+        }
+        miidCacheMisses++;
+    }
+
+    ret = queryModuleInstanceId(mixer, device, intf_name, tag_id, miid);
+    if (!ret) {
+        std::lock_guard<std::mutex> lock(miidCacheMutex);
+        miidCache[key] = *miid;
+    }
+    return ret;
+}
+
+void SessionAlsaUtils::invalidateMiidCache()
+{
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+
+    PAL_DBG(LOG_TAG, "dropping %zu cached MIIDs, hits %llu misses %llu",
+            miidCache.size(), (unsigned long long)miidCacheHits,
+            (unsigned long long)miidCacheMisses);
+    miidCache.clear();
+}
+
+void SessionAlsaUtils::invalidateMiidCache(const std::vector<int> &devIds)
+{
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+
+    for (auto it = miidCache.begin(); it != miidCache.end();) {
+        if (std::find(devIds.begin(), devIds.end(), std::get<1>(it->first)) != devIds.end())
+            it = miidCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+void SessionAlsaUtils::getMiidCacheStats(uint64_t *hits, uint64_t *misses)
+{
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+
+    if (hits)
+        *hits = miidCacheHits;
+    if (misses)
+        *misses = miidCacheMisses;
+}
+
+int SessionAlsaUtils::queryModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
+                       int tag_id, uint32_t *miid)
 {
     char *pcmDeviceName = NULL;
     char const *control = "getTaggedInfo";
@@ -1471,6 +1604,8 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
     const std::vector<std::pair<int32_t, std::string>> &rxBackEnds,
     const std::vector<std::pair<int32_t, std::string>> &txBackEnds)
 {
+    invalidateMiidCache(RxDevIds);
+    invalidateMiidCache(TxDevIds);
     std::vector <std::pair<int, int>> streamRxKV, streamTxKV;
     std::vector <std::pair<int, int>> streamRxCKV, streamTxCKV;
     std::vector <std::pair<int, int>> streamDeviceRxKV, streamDeviceTxKV;
@@ -1885,6 +2020,8 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     const std::vector<std::pair<int32_t, std::string>> &txBackEnds,
     std::vector<std::pair<std::string, int>> &freeDeviceMetaData)
 {
+    invalidateMiidCache(RxDevIds);
+    invalidateMiidCache(TxDevIds);
     int status = 0;
     std::vector <std::pair<int, int>> emptyKV;
     struct pal_stream_attributes sAttr;
@@ -2069,6 +2206,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
         const std::vector<int> &pcmDevIds,
         const std::vector<std::pair<int32_t, std::string>> &aifBackEndsToDisconnect)
 {
+    invalidateMiidCache(pcmDevIds);
     std::ostringstream disconnectCtrlName;
     int status = 0;
     struct mixer *mixerHandle = nullptr;
@@ -2208,6 +2346,8 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
         const std::vector<int> &pcmTxDevIds,const std::vector<int> &pcmRxDevIds,
         const std::vector<std::pair<int32_t, std::string>> &aifBackEndsToDisconnect)
 {
+    invalidateMiidCache(pcmTxDevIds);
+    invalidateMiidCache(pcmRxDevIds);
     std::ostringstream disconnectCtrlName;
     int status = 0;
     struct mixer *mixerHandle = nullptr;
@@ -2255,6 +2395,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         const std::vector<int> &pcmDevIds,
         const std::vector<std::pair<int32_t, std::string>> &aifBackEndsToConnect)
 {
+    invalidateMiidCache(pcmDevIds);
     struct mixer_ctl *connectCtrl;
     struct mixer *mixerHandle = nullptr;
     bool is_compress = false;
@@ -2433,6 +2574,8 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         const std::vector<int> &pcmTxDevIds,const std::vector<int> &pcmRxDevIds,
         const std::vector<std::pair<int32_t, std::string>> &aifBackEndsToConnect)
 {
+    invalidateMiidCache(pcmTxDevIds);
+    invalidateMiidCache(pcmRxDevIds);
     std::ostringstream connectCtrlName;
     int status = 0;
     struct mixer *mixerHandle = nullptr;
@@ -2520,11 +2663,13 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
         const std::vector<int> &pcmDevIds,
         const std::vector<std::pair<int32_t, std::string>> &aifBackEndsToConnect)
 {
+    invalidateMiidCache(pcmDevIds);
     std::ostringstream cntrlName;
     std::ostringstream aifMdName;
     std::ostringstream aifMfCtrlName;
     std::ostringstream feMdName;
     std::ostringstream connectCtrlName;
+    std::ostringstream feName;
     std::vector <std::pair<int, int>> streamDeviceKV;
     std::vector <std::pair<int, int>> deviceKV;
     std::vector <std::pair<int, int>> emptyKV;
@@ -2671,6 +2816,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
 
     switch (streamType) {
         case PAL_STREAM_COMPRESSED:
+            feName << COMPRESS_SND_DEV_NAME_PREFIX << pcmDevIds.at(0);
             cntrlName << COMPRESS_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " control";
             aifMdName << aifBackEndsToConnect[0].second.data() << " metadata";
             feMdName << COMPRESS_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " metadata";
@@ -2689,10 +2835,12 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
                 sub = 2;
 
             if (dAttr.id > PAL_DEVICE_OUT_MIN && dAttr.id < PAL_DEVICE_OUT_MAX) {
+                feName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "p";
                 cntrlName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "p" << " control";
                 aifMdName << aifBackEndsToConnect[0].second.data() << " metadata";
                 feMdName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "p" << " metadata";
             } else if (dAttr.id > PAL_DEVICE_IN_MIN && dAttr.id < PAL_DEVICE_IN_MAX) {
+                feName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "c";
                 cntrlName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "c" << " control";
                 aifMdName << aifBackEndsToConnect[0].second.data() << " metadata";
                 feMdName << PCM_SND_VOICE_DEV_NAME_PREFIX << sub << "c" << " metadata";
@@ -2700,6 +2848,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
             }
             break;
         default:
+            feName << PCM_SND_DEV_NAME_PREFIX << pcmDevIds.at(0);
             cntrlName << PCM_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " control";
             aifMdName << aifBackEndsToConnect[0].second.data() << " metadata";
             feMdName << PCM_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " metadata";
@@ -2708,7 +2857,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
 
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
 
-    aifMdCtrl = mixer_get_ctl_by_name(mixerHandle, aifMdName.str().data());
+    aifMdCtrl = getBeMixerControl(mixerHandle, aifBackEndsToConnect[0].second, BE_METADATA);
     PAL_DBG(LOG_TAG, "mixer control %s", aifMdName.str().data());
     if (!aifMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", aifMdName.str().data());
@@ -2718,7 +2867,9 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     if (deviceMetaData.size)
         mixer_ctl_set_array(aifMdCtrl, (void *)deviceMetaData.buf, deviceMetaData.size);
 
-    feCtrl = mixer_get_ctl_by_name(mixerHandle, cntrlName.str().data());
+    /* cached lookup without getFeMixerControl's abort on a missing control */
+    feCtrl = getCachedMixerControl(mixerHandle, feName.str(), FE_CONTROL,
+            feCtrlNames[FE_CONTROL]);
     PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
     if (!feCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
@@ -2727,7 +2878,8 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     }
     mixer_ctl_set_enum_by_string(feCtrl, aifBackEndsToConnect[0].second.data());
 
-    feMdCtrl = mixer_get_ctl_by_name(mixerHandle, feMdName.str().data());
+    feMdCtrl = getCachedMixerControl(mixerHandle, feName.str(), FE_METADATA,
+            feCtrlNames[FE_METADATA]);
     PAL_DBG(LOG_TAG, "mixer control %s", feMdName.str().data());
     if (!feMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", feMdName.str().data());
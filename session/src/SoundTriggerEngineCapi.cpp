@@ -48,6 +48,22 @@
 #define CNN_BUFFER_LENGTH 10000
 #define CNN_FRAME_SIZE 320
 
+/*
+ * CAPI process() takes one contiguous buffer. Hand it the ring storage in
+ * place and only assemble the data in scratch when the view wraps. The
+ * second-stage modules only read their input.
+ */
+static char *GetProcessInput(struct pal_ring_buffer_view *view, char *scratch)
+{
+    if (view->segSize[1] == 0)
+        return (char *)view->seg[0];
+
+    ar_mem_cpy(scratch, view->size, view->seg[0], view->segSize[0]);
+    ar_mem_cpy(scratch + view->segSize[0], view->size - view->segSize[0],
+               view->seg[1], view->segSize[1]);
+    return scratch;
+}
+
 ST_DBG_DECLARE(static int keyword_detection_cnt = 0);
 ST_DBG_DECLARE(static int user_verification_cnt = 0);
 
@@ -140,6 +156,8 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
 {
     int32_t status = 0;
     char *process_input_buff = nullptr;
+    char *process_input = nullptr;
+    struct pal_ring_buffer_view view;
     capi_v2_err_t rc = CAPI_V2_EOK;
     capi_v2_stream_data_t *stream_input = nullptr;
     sva_result_t *result_cfg_ptr = nullptr;
@@ -200,7 +218,9 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
     }
 
     memset(&capi_result, 0, sizeof(capi_result));
-    process_input_buff = (char*)calloc(1, buffer_size_);
+    /* scratch for wrapped views, later buffers are lab_buffer_size long */
+    process_input_buff = (char*)calloc(1,
+        std::max((size_t)buffer_size_, lab_buffer_size));
     if (!process_input_buff) {
         status = -ENOMEM;
         PAL_ERR(LOG_TAG, "failed to allocate process input buff, status %d",
@@ -253,7 +273,7 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
         if (!reader_->waitForBuffers(buffer_size_))
             continue;
 
-        read_size = reader_->read((void*)process_input_buff, buffer_size_);
+        read_size = reader_->acquireView(&view, buffer_size_);
         if (read_size == 0) {
             continue;
         } else if (read_size < 0) {
@@ -261,17 +281,18 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
             PAL_ERR(LOG_TAG, "Failed to read from buffer, status %d", status);
             goto exit;
         }
+        process_input = GetProcessInput(&view, process_input_buff);
 
         PAL_INFO(LOG_TAG, "Processed: %u, start: %u, end: %u",
                  bytes_processed_, buffer_start_, buffer_end_);
         stream_input->bufs_num = 1;
         stream_input->buf_ptr->max_data_len = buffer_size_;
         stream_input->buf_ptr->actual_data_len = read_size;
-        stream_input->buf_ptr->data_ptr = (int8_t *)process_input_buff;
+        stream_input->buf_ptr->data_ptr = (int8_t *)process_input;
 
         if (vui_ptfm_info_->GetEnableDebugDumps()) {
             ST_DBG_FILE_WRITE(keyword_detection_fd,
-                process_input_buff, read_size);
+                process_input, read_size);
         }
 
         PAL_VERBOSE(LOG_TAG, "Calling Capi Process");
@@ -280,6 +301,7 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
         rc = capi_handle_->vtbl_ptr->process(capi_handle_,
             &stream_input, nullptr);
         ATRACE_END();
+        reader_->commitView(read_size);
         capi_call_end = std::chrono::steady_clock::now();
         total_capi_process_duration +=
             std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -383,6 +405,8 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
 {
     int32_t status = 0;
     char *process_input_buff = nullptr;
+    char *process_input = nullptr;
+    struct pal_ring_buffer_view view;
     capi_v2_err_t rc = CAPI_V2_EOK;
     capi_v2_stream_data_t *stream_input = nullptr;
     capi_v2_buf_t capi_uv_ptr;
@@ -530,7 +554,7 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
         if (!reader_->waitForBuffers(buffer_size_))
             continue;
 
-        read_size = reader_->read((void*)process_input_buff, buffer_size_);
+        read_size = reader_->acquireView(&view, buffer_size_);
         if (read_size == 0) {
             continue;
         } else if (read_size < 0) {
@@ -538,16 +562,17 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
             PAL_ERR(LOG_TAG, "Failed to read from buffer, status %d", status);
             goto exit;
         }
+        process_input = GetProcessInput(&view, process_input_buff);
         PAL_INFO(LOG_TAG, "Processed: %u, start: %u, end: %u",
                  bytes_processed_, buffer_start_, buffer_end_);
         stream_input->bufs_num = 1;
         stream_input->buf_ptr->max_data_len = buffer_size_;
         stream_input->buf_ptr->actual_data_len = read_size;
-        stream_input->buf_ptr->data_ptr = (int8_t *)process_input_buff;
+        stream_input->buf_ptr->data_ptr = (int8_t *)process_input;
 
         if (vui_ptfm_info_->GetEnableDebugDumps()) {
             ST_DBG_FILE_WRITE(user_verification_fd,
-                process_input_buff, read_size);
+                process_input, read_size);
         }
 
         PAL_VERBOSE(LOG_TAG, "Calling Capi Process\n");
@@ -556,6 +581,7 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
         rc = capi_handle_->vtbl_ptr->process(capi_handle_,
             &stream_input, nullptr);
         ATRACE_END();
+        reader_->commitView(read_size);
         capi_call_end = std::chrono::steady_clock::now();
         total_capi_process_duration +=
             std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "TimestampExtrapolator.h"
+
+TimestampExtrapolator::TimestampExtrapolator(uint64_t maxAgeUs, double maxDrift)
+    : maxAgeUs_(maxAgeUs),
+      maxDrift_(maxDrift)
+{
+    reset();
+}
+
+/* the session clock is discontinuous across start/stop/pause/flush */
+void TimestampExtrapolator::reset()
+{
+    valid_ = false;
+    sessionUs_ = 0;
+    absoluteUs_ = 0;
+    hostUs_ = 0;
+    refSessionUs_ = 0;
+    refAbsoluteUs_ = 0;
+    lastReportedUs_ = 0;
+    rate_ = 0;
+}
+
+/*
+ * Record a DSP reading taken at hostUs and return the session time to
+ * report for it. The rate is re-measured once the DSP window since the
+ * reference reading spans maxAgeUs; shorter windows only move the base
+ * of the extrapolation, since session time granularity would dominate
+ * them. A rate outside 1 +/- maxDrift (pause, underrun, seek) or a
+ * clock going backwards stops extrapolation until two readings agree
+ * again.
+ */
+uint64_t TimestampExtrapolator::update(uint64_t sessionUs, uint64_t absoluteUs,
+                                       uint64_t hostUs)
+{
+    double measured = 0;
+    uint64_t reported = sessionUs;
+
+    if (!valid_ || absoluteUs < refAbsoluteUs_ || sessionUs < refSessionUs_) {
+        rate_ = 0;
+        refSessionUs_ = sessionUs;
+        refAbsoluteUs_ = absoluteUs;
+    } else if (absoluteUs - refAbsoluteUs_ >= maxAgeUs_) {
+        measured = (double)(sessionUs - refSessionUs_) / (absoluteUs - refAbsoluteUs_);
+        if (measured < 1 - maxDrift_ || measured > 1 + maxDrift_)
+            rate_ = 0;
+        else if (rate_ == 0)
+            rate_ = measured;
+        else
+            rate_ += (measured - rate_) / 4;
+        refSessionUs_ = sessionUs;
+        refAbsoluteUs_ = absoluteUs;
+    }
+
+    /* hide the small overshoot of the previous extrapolation */
+    if (valid_ && sessionUs < lastReportedUs_ &&
+        lastReportedUs_ - sessionUs < maxAgeUs_)
+        reported = lastReportedUs_;
+    lastReportedUs_ = reported;
+
+    sessionUs_ = sessionUs;
+    absoluteUs_ = absoluteUs;
+    hostUs_ = hostUs;
+    valid_ = true;
+
+    return reported;
+}
+
+/*
+ * Returns -EAGAIN when the caller has to read the DSP: no reading yet,
+ * the reading is older than maxAgeUs, or no trusted rate is known.
+ */
+int TimestampExtrapolator::extrapolate(uint64_t hostUs, uint64_t *sessionUs,
+                                       uint64_t *absoluteUs)
+{
+    uint64_t elapsed = 0;
+    uint64_t session = 0;
+
+    if (!valid_ || rate_ == 0 || hostUs < hostUs_)
+        return -EAGAIN;
+    elapsed = hostUs - hostUs_;
+    if (elapsed >= maxAgeUs_)
+        return -EAGAIN;
+
+    session = sessionUs_ + (uint64_t)(rate_ * elapsed);
+    /* never step back behind what was already reported */
+    if (session < lastReportedUs_)
+        session = lastReportedUs_;
+    lastReportedUs_ = session;
+
+    *sessionUs = session;
+    *absoluteUs = absoluteUs_ + elapsed;
+    return 0;
+}
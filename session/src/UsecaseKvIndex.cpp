@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "UsecaseKvIndex.h"
+#include <algorithm>
+
+/*
+ * Pre-sort selectors of every keys_and_values entry and index the parsed
+ * list by id type, so that find() does not have to walk and re-sort the
+ * whole XML tree on each stream/device setup.
+ */
+void UsecaseKvIndex::build(std::vector<allKVs> &any_type, kvTypeIndex &index)
+{
+    index.clear();
+    for (uint32_t i = 0; i < any_type.size(); i++) {
+        for (int32_t id : any_type[i].id_type) {
+            std::vector<uint32_t> &entries = index[id];
+            if (entries.empty() || entries.back() != i)
+                entries.push_back(i);
+        }
+        for (auto &info : any_type[i].keys_values)
+            std::sort(info.selector_pairs.begin(), info.selector_pairs.end());
+    }
+}
+
+const std::vector<uint32_t> *UsecaseKvIndex::getEntries(int32_t type,
+    const kvTypeIndex &index)
+{
+    auto it = index.find(type);
+
+    if (it == index.end())
+        return nullptr;
+    return &it->second;
+}
+
+/*
+ * Collects, for every block of the given type, the first entry whose
+ * selectors equal or include the filled ones. keys_values is ordered by
+ * selector count, so an exact match wins over a superset, as in the
+ * linear search this replaced. Sorts filled_selector_pairs.
+ */
+bool UsecaseKvIndex::find(std::vector<std::pair<selector_type_t, std::string>>
+    &filled_selector_pairs, int32_t type, std::vector<allKVs> &any_type,
+    const kvTypeIndex &index, std::vector<const struct kvInfo *> &matches)
+{
+    bool found = false;
+    const std::vector<uint32_t> *entries = getEntries(type, index);
+
+    if (!entries)
+        return found;
+
+    std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
+
+    for (uint32_t i : *entries) {
+        for (auto &info : any_type[i].keys_values) {
+            const auto &pairs = info.selector_pairs;
+
+            if (pairs.size() < filled_selector_pairs.size())
+                continue;
+            if (pairs.size() == filled_selector_pairs.size()) {
+                if (!std::equal(pairs.begin(), pairs.end(), filled_selector_pairs.begin()))
+                    continue;
+            } else if (filled_selector_pairs.empty() ||
+                       !std::includes(pairs.begin(), pairs.end(),
+                           filled_selector_pairs.begin(), filled_selector_pairs.end())) {
+                continue;
+            }
+            matches.push_back(&info);
+            found = true;
+            break;
+        }
+    }
+    return found;
+}
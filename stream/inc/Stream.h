@@ -205,6 +205,7 @@ protected:
     bool mutexLockedbyRm = false;
     bool mDutyCycleEnable = false;
     sem_t mInUse;
+    pal_stream_handle_t *mStreamHandle = NULL;
     int connectToDefaultDevice(Stream* streamHandle, uint32_t dir);
 public:
     virtual ~Stream() {};
@@ -250,6 +251,8 @@ public:
     virtual int32_t GetMmapPosition(struct pal_mmap_position *position __unused) {return -EINVAL;}
     virtual int32_t getTagsWithModuleInfo(size_t *size __unused, uint8_t *payload __unused) {return -EINVAL;};
     virtual bool ConfigSupportLPI() {return true;}; //Only LPI streams can update their vote to NLPI
+    /* wait, with mStreamMutex held, for read/write running outside it */
+    virtual void waitForIoDrain_l() {}
     int32_t getStreamAttributes(struct pal_stream_attributes *sattr);
     int32_t getModifiers(struct modifier_kv *modifiers,uint32_t *noOfModifiers);
     const std::string& getStreamSelector() const;
@@ -259,6 +262,10 @@ public:
     uint32_t getRenderLatency();
     uint32_t getLatency();
     int32_t getAssociatedDevices(std::vector <std::shared_ptr<Device>> &adevices);
+    bool hasAssociatedDevices() { return !mDevices.empty(); }
+    bool isDeviceAssociated(const std::shared_ptr<Device> &dev) {
+        return std::find(mDevices.begin(), mDevices.end(), dev) != mDevices.end();
+    }
     int32_t getPalDevices(std::vector <std::shared_ptr<Device>> &PalDevices);
     void clearOutPalDevices(Stream *streamHandle);
     void addPalDevice(Stream* streamHandle, struct pal_device *dattr);
@@ -289,6 +296,9 @@ public:
     int switchDevice(Stream* streamHandle, uint32_t no_of_devices, struct pal_device *deviceArray);
     bool isGKVMatch(pal_key_vector_t* gkv);
     int32_t getEffectParameters(void *effect_query, size_t *payload_size);
+    /* opaque handle given to the client, also used in client callbacks */
+    pal_stream_handle_t* getStreamHandle() { return mStreamHandle; }
+    void setStreamHandle(pal_stream_handle_t *handle) { mStreamHandle = handle; }
     uint32_t getInstanceId() { return mInstanceID; }
     inline void setInstanceId(uint32_t sid) { mInstanceID = sid; }
     int initStreamSmph();
@@ -42,6 +42,7 @@
 #include "ACDPlatformInfo.h"
 #include "SoundTriggerUtils.h"
 #include "ContextDetectionEngine.h"
+#include "PalExecutor.h"
 
 class ContextDetectionEngine;
 
@@ -438,7 +439,7 @@ class StreamACD : public Stream {
 
     int32_t GenerateCallbackEvent(struct pal_acd_recognition_event **event,
                                   uint32_t *event_size);
-    static void EventNotificationThread(StreamACD *stream);
+    void PostCachedEventNotification();
 
     std::shared_ptr<ACDStreamConfig> sm_cfg_;
     std::shared_ptr<ACDPlatformInfo> acd_info_;
@@ -469,9 +470,7 @@ class StreamACD : public Stream {
     std::map<uint32_t, ACDState*> acd_states_;
     bool use_lpi_;
  protected:
-    std::thread notification_thread_handler_;
+    std::shared_ptr<PalStrand> notification_strand_;
     std::mutex mutex_;
-    std::condition_variable cv_;
-    bool exit_thread_;
 };
 #endif // STREAMACD_H_
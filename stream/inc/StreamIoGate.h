@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef STREAM_IO_GATE_H
+#define STREAM_IO_GATE_H
+
+#include <condition_variable>
+#include <errno.h>
+#include <mutex>
+#include <stdint.h>
+
+/*
+ * Admission of data-plane read/write calls that run in the session
+ * without the stream lock. Methods ending in _l are called with the
+ * stream lock held; enter_l() needs it too, so while a control path holds
+ * the lock the in-flight count can only go down.
+ *
+ * While the session is paused no I/O is admitted: a pcm write on a paused
+ * session can block until resume, and resume needs the stream lock that a
+ * draining stop, flush or device switch holds. Keeping paused sessions
+ * free of I/O keeps every drain bounded by one running period.
+ */
+class StreamIoGate {
+public:
+    StreamIoGate() : inFlight_(0), paused_(false) {};
+    int enter_l();
+    void exit();
+    void drain_l();
+    void setPaused_l(bool paused) { paused_ = paused; }
+    bool isPaused_l() const { return paused_; }
+    uint32_t inFlight();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    uint32_t inFlight_;
+    bool paused_;
+};
+
+#endif // STREAM_IO_GATE_H
@@ -31,6 +31,7 @@
 #define STREAMPCM_H_
 
 #include "Stream.h"
+#include "StreamIoGate.h"
 
 class ResourceManager;
 class Device;
@@ -72,6 +73,7 @@ public:
    int32_t createMmapBuffer(int32_t min_size_frames,
                                    struct pal_mmap_buffer *info) override;
    int32_t GetMmapPosition(struct pal_mmap_position *position) override;
+   void waitForIoDrain_l() override;
 
    static int32_t isSampleRateSupported(uint32_t sampleRate);
    static int32_t isChannelSupported(uint32_t numChannels);
@@ -79,6 +81,8 @@ public:
 
 private:
     uint32_t volRampPeriodms;
+    /* read/write calls inside the session outside mStreamMutex */
+    StreamIoGate mIoGate;
 };
 
 #endif//STREAMPCM_H_
@@ -519,6 +519,8 @@ private:
     void PostDelayedStop();
     void CancelDelayedStop();
     void InternalStopRecognition();
+    void EndLabRead();
+    void WaitForLabReadDrain();
     std::thread timer_thread_;
     std::mutex timer_mutex_;
     std::condition_variable timer_start_cond_;
@@ -550,6 +552,11 @@ private:
     pal_stream_callback callback_;
     uint64_t cookie_;
     PalRingBufferReader *reader_;
+    /* reads blocked on reader_ without mStreamMutex held */
+    uint32_t lab_reads_in_flight_;
+    std::mutex lab_read_mutex_;
+    std::condition_variable lab_read_cond_;
+    std::shared_ptr<StEventConfig> read_buf_ev_cfg_;
     uint8_t *gsl_engine_model_;
     uint32_t gsl_engine_model_size_;
     uint8_t *gsl_conf_levels_;
@@ -1127,6 +1127,7 @@ int32_t Stream::disconnectStreamDevice_l(Stream* streamHandle, pal_device_id_t d
         goto exit;
     }
 
+    waitForIoDrain_l();
     // Stream does not know if the same device is being used by other streams or not
     // So if any other streams are using the same device that has to be handled outside of stream
     // resouce manager ??
@@ -1259,6 +1260,7 @@ int32_t Stream::connectStreamDevice_l(Stream* streamHandle, struct pal_device *d
         goto exit;
     }
 
+    waitForIoDrain_l();
     mDevices.push_back(dev);
     status = session->setupSessionDevice(streamHandle, mStreamAttr->type, dev);
     if (0 != status) {
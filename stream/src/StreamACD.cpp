@@ -55,7 +55,6 @@ StreamACD::StreamACD(struct pal_stream_attributes *sattr,
     paused_ = false;
     device_opened_ = false;
     currentState = STREAM_IDLE;
-    exit_thread_ = false;
     acd_idle_ = nullptr;
     acd_loaded_ = nullptr;
     acd_active = nullptr;
@@ -116,12 +115,7 @@ StreamACD::StreamACD(struct pal_stream_attributes *sattr,
         throw std::runtime_error("ACD not enabled, exiting");
     }
 
-    notification_thread_handler_ = std::thread(EventNotificationThread, this);
-    if (!notification_thread_handler_.joinable()) {
-        PAL_ERR(LOG_TAG, "Error:%d failed to create notification thread",
-                -EINVAL);
-        throw std::runtime_error("failed to create notification thread");
-    }
+    notification_strand_ = PalExecutor::getInstance()->createStrand("acd_notify");
     rm->registerStream(this);
 
     // Create internal states
@@ -168,13 +162,9 @@ exit:
 StreamACD::~StreamACD()
 {
     acd_states_.clear();
-    exit_thread_ = true;
-    if (notification_thread_handler_.joinable()) {
-        std::unique_lock<std::mutex> lck(mutex_);
-        cv_.notify_one();
-        lck.unlock();
-        notification_thread_handler_.join();
-        PAL_INFO(LOG_TAG, "Thread joined");
+    if (notification_strand_) {
+        notification_strand_->shutdown();
+        PAL_INFO(LOG_TAG, "Notification strand shut down");
     }
 
     rm->deregisterStream(this);
@@ -553,13 +543,13 @@ notify:
          *  Unlock it before calling callback */
         notificationInProgress = true;
         mutex_.unlock();
-        callback_((pal_stream_handle_t *)this, 0, ev_payload, event_size, cookie_);
+        callback_(getStreamHandle(), 0, ev_payload, event_size, cookie_);
         free(ev_payload);
         ev_payload = NULL;
         mutex_.lock();
         notificationInProgress = false;
         /* If mutex_ lock is acquired by other thread handling detection event before
-         * this thread, then cv_.notify_one will not be handled. Handle it here and
+         * this thread, it defers instead of posting a notification. Handle it here and
          * notify client if there is pending notification to be sent to client.
          */
         if (deferredNotification == true && cached_event_data_ != NULL) {
@@ -987,24 +977,19 @@ exit:
     return status;
 }
 
-void StreamACD::EventNotificationThread(StreamACD *stream)
+/*
+ * Called with mutex_ held. Delivery runs on the shared executor instead of
+ * a per-stream thread; the strand keeps notifications in order.
+ */
+void StreamACD::PostCachedEventNotification()
 {
-    PAL_DBG(LOG_TAG, "Enter. start thread loop");
-
-    std::unique_lock<std::mutex> lck(stream->mutex_);
-    while (!stream->exit_thread_) {
-        PAL_DBG(LOG_TAG, "waiting on cond");
-        stream->cv_.wait(lck);
-        PAL_INFO(LOG_TAG, "Received start recognition");
-
-        if (stream->exit_thread_) {
-            PAL_DBG(LOG_TAG, "Exit thread");
-            break;
-        }
+    notification_strand_->post([this] {
+        std::unique_lock<std::mutex> lck(mutex_);
 
-        stream->SendCachedEventData();
-    }
-    PAL_DBG(LOG_TAG, "Exit");
+        PAL_INFO(LOG_TAG, "Notify cached event");
+        if (cached_event_data_)
+            SendCachedEventData();
+    });
 }
 
 int32_t StreamACD::ACDIdle::ProcessEvent(
@@ -1217,7 +1202,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
                 acd_stream_.state_for_restore_ = ACD_STATE_NONE;
             } else if (acd_stream_.cached_event_data_) {
                 std::unique_lock<std::mutex> lck(acd_stream_.mutex_);
-                acd_stream_.cv_.notify_one();
+                acd_stream_.PostCachedEventNotification();
                 TransitTo(ACD_STATE_DETECTED);
             }
             break;
@@ -1445,7 +1430,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
                 if (acd_stream_.notificationInProgress == true)
                     acd_stream_.deferredNotification = true;
                 else
-                    acd_stream_.cv_.notify_one();
+                    acd_stream_.PostCachedEventNotification();
                 TransitTo(ACD_STATE_DETECTED);
             }
             break;
@@ -1728,7 +1713,7 @@ int32_t StreamACD::ACDDetected::ProcessEvent(
                 if (acd_stream_.notificationInProgress == true)
                     acd_stream_.deferredNotification = true;
                 else
-                    acd_stream_.cv_.notify_one();
+                    acd_stream_.PostCachedEventNotification();
             } else {
                 TransitTo(ACD_STATE_ACTIVE);
             }
@@ -1898,7 +1883,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
                 if ((acd_stream_.state_for_restore_ == ACD_STATE_DETECTED) &&
                     (acd_stream_.cached_event_data_ != NULL)) {
                     std::unique_lock<std::mutex> lck(acd_stream_.mutex_);
-                    acd_stream_.cv_.notify_one();
+                    acd_stream_.PostCachedEventNotification();
                 } else {
                     acd_stream_.state_for_restore_ = ACD_STATE_ACTIVE;
                 }
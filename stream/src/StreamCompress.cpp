@@ -60,7 +60,7 @@ static void handleSessionCallBack(uint64_t hdl, uint32_t event_id, void *data,
     else {
         s = reinterpret_cast<Stream *>(hdl);
         if (s->getCallBack(&cb) == 0)
-            cb(reinterpret_cast<pal_stream_handle_t *>(s), event_id, (uint32_t *)data,
+            cb(s->getStreamHandle(), event_id, (uint32_t *)data,
                event_size, s->cookie);
     }
 }
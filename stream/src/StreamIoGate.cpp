@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "StreamIoGate.h"
+
+/* Returns -EAGAIN while the session is paused, else admits one call */
+int StreamIoGate::enter_l()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (paused_)
+        return -EAGAIN;
+    inFlight_++;
+    return 0;
+}
+
+void StreamIoGate::exit()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (--inFlight_ == 0)
+        cv_.notify_all();
+}
+
+/* Waits for admitted calls to return before the session state changes */
+void StreamIoGate::drain_l()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    cv_.wait(lock, [this] { return inFlight_ == 0; });
+}
+
+uint32_t StreamIoGate::inFlight()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return inFlight_;
+}
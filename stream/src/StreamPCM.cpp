@@ -315,6 +315,7 @@ int32_t  StreamPCM::close()
         }
     }
 
+    waitForIoDrain_l();
     rm->lockGraph();
     status = session->close(this);
     if (0 != status) {
@@ -671,6 +672,9 @@ int32_t StreamPCM::stop()
             rm->deregisterDevice(mDevices[i], this);
         }
         rm->unlockActiveStream();
+        waitForIoDrain_l();
+        /* the session restarts running, admit I/O again */
+        mIoGate.setPaused_l(false);
         switch (mStreamAttr->direction) {
         case PAL_AUDIO_OUTPUT:
             PAL_VERBOSE(LOG_TAG, "In PAL_AUDIO_OUTPUT case, device count - %zu",
@@ -917,6 +921,7 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
         uint32_t sampleRate = mStreamAttr->in_media_config.sample_rate;
         struct pal_channel_info chInfo = mStreamAttr->in_media_config.ch_info;
 
+        mStreamMutex.unlock();
         streamSize = byteWidth * chInfo.channels;
         if ((streamSize == 0) || (sampleRate == 0)) {
             PAL_ERR(LOG_TAG, "stream_size= %d, srate = %d",
@@ -932,37 +937,48 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
         goto exit;
     }
 
-    if (currentState == STREAM_STARTED) {
-        status = session->read(this, SHMEM_ENDPOINT, buf, &size);
-        if (0 != status) {
-            PAL_ERR(LOG_TAG, "session read is failed with status %d", status);
-            if (errno == -ENETRESET &&
-                rm->cardState != CARD_STATUS_OFFLINE) {
-                PAL_ERR(LOG_TAG, "Sound card offline, informing RM");
-                rm->ssrHandler(CARD_STATUS_OFFLINE);
-                size = buf->size;
-                status = size;
-                PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-                goto exit;
-            } else if (rm->cardState == CARD_STATUS_OFFLINE) {
-                size = buf->size;
-                status = size;
-                PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-                goto exit;
-            } else {
-                goto exit;
-            }
-        }
-    } else {
+    if (currentState != STREAM_STARTED) {
         PAL_ERR(LOG_TAG, "Stream not started yet, state %d", currentState);
+        mStreamMutex.unlock();
         status = -EINVAL;
         goto exit;
     }
+
+    /* Blocking pcm read must not hold mStreamMutex, otherwise control
+     * operations on this stream queue behind it for up to a period.
+     * The I/O gate keeps control paths from changing the session
+     * underneath us.
+     */
+    status = mIoGate.enter_l();
     mStreamMutex.unlock();
+    if (status) {
+        PAL_ERR(LOG_TAG, "Stream paused, read not accepted");
+        goto exit;
+    }
+    status = session->read(this, SHMEM_ENDPOINT, buf, &size);
+    mIoGate.exit();
+    if (0 != status) {
+        PAL_ERR(LOG_TAG, "session read is failed with status %d", status);
+        if (errno == -ENETRESET &&
+            rm->cardState != CARD_STATUS_OFFLINE) {
+            PAL_ERR(LOG_TAG, "Sound card offline, informing RM");
+            rm->ssrHandler(CARD_STATUS_OFFLINE);
+            size = buf->size;
+            status = size;
+            PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+            goto exit;
+        } else if (rm->cardState == CARD_STATUS_OFFLINE) {
+            size = buf->size;
+            status = size;
+            PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+            goto exit;
+        } else {
+            goto exit;
+        }
+    }
     PAL_VERBOSE(LOG_TAG, "Exit. session read successful size - %d", size);
     return size;
 exit :
-    mStreamMutex.unlock();
     PAL_DBG(LOG_TAG, "Exit. session read failed status %d", status);
     return status;
 }
@@ -975,6 +991,7 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
     uint32_t byteWidth = 0;
     uint32_t sampleRate = 0;
     uint32_t channelCount = 0;
+    bool wasPaused = false;
 
     PAL_VERBOSE(LOG_TAG, "Enter. session handle - %pK, state %d",
             session, currentState);
@@ -986,60 +1003,24 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
         byteWidth = mStreamAttr->out_media_config.bit_width / 8;
         sampleRate = mStreamAttr->out_media_config.sample_rate;
         channelCount = mStreamAttr->out_media_config.ch_info.channels;
+        mStreamMutex.unlock();
 
         frameSize = byteWidth * channelCount;
         if ((frameSize == 0) || (sampleRate == 0)) {
             PAL_ERR(LOG_TAG, "frameSize=%d, sampleRate=%d", frameSize, sampleRate);
-            mStreamMutex.unlock();
             status = -EINVAL;
             goto exit;
         }
         size = buf->size;
         usleep((uint64_t)size * 1000000 / frameSize / sampleRate);
         PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-        mStreamMutex.unlock();
         PAL_VERBOSE(LOG_TAG, "Exit size: %d", size);
         return size;
     }
 
     // we should allow writes to go through in Start/Pause state as well.
-    if ((currentState == STREAM_STARTED) ||
-        (currentState == STREAM_PAUSED) ) {
-        status = session->write(this, SHMEM_ENDPOINT, buf, &size, 0);
-        mStreamMutex.unlock();
-        if (0 != status) {
-            PAL_ERR(LOG_TAG, "session write is failed with status %d", status);
-
-            /* ENETRESET is the error code returned by AGM during SSR */
-            if (errno == -ENETRESET &&
-                rm->cardState != CARD_STATUS_OFFLINE) {
-                PAL_ERR(LOG_TAG, "Sound card offline, informing RM");
-                rm->ssrHandler(CARD_STATUS_OFFLINE);
-                size = buf->size;
-                status = size;
-                PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-                goto exit;
-            } else if (rm->cardState == CARD_STATUS_OFFLINE) {
-                size = buf->size;
-                status = size;
-                PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-                goto exit;
-            } else {
-                goto exit;
-            }
-        } else if (currentState == STREAM_PAUSED && !isPaused) {
-            rm->lockActiveStream();
-            mStreamMutex.lock();
-            for (int i = 0; i < mDevices.size(); i++) {
-                rm->registerDevice(mDevices[i], this);
-            }
-            mStreamMutex.unlock();
-            rm->unlockActiveStream();
-            currentState = STREAM_STARTED;
-        }
-        PAL_VERBOSE(LOG_TAG, "Exit. session write successful size - %d", size);
-        return size;
-    } else {
+    if ((currentState != STREAM_STARTED) &&
+        (currentState != STREAM_PAUSED)) {
         PAL_ERR(LOG_TAG, "Stream not started yet, state %d", currentState);
         if (currentState == STREAM_STOPPED)
             status = -EIO;
@@ -1050,11 +1031,71 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
         goto exit;
     }
 
+    /* See read(): the blocking pcm write runs outside mStreamMutex. */
+    wasPaused = (currentState == STREAM_PAUSED);
+    status = mIoGate.enter_l();
+    mStreamMutex.unlock();
+    if (status) {
+        /* a paused session may hold the write until resume, see StreamIoGate */
+        PAL_ERR(LOG_TAG, "Stream paused, write not accepted");
+        goto exit;
+    }
+    status = session->write(this, SHMEM_ENDPOINT, buf, &size, 0);
+    mIoGate.exit();
+    if (0 != status) {
+        PAL_ERR(LOG_TAG, "session write is failed with status %d", status);
+
+        /* ENETRESET is the error code returned by AGM during SSR */
+        if (errno == -ENETRESET &&
+            rm->cardState != CARD_STATUS_OFFLINE) {
+            PAL_ERR(LOG_TAG, "Sound card offline, informing RM");
+            rm->ssrHandler(CARD_STATUS_OFFLINE);
+            size = buf->size;
+            status = size;
+            PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+            goto exit;
+        } else if (rm->cardState == CARD_STATUS_OFFLINE) {
+            size = buf->size;
+            status = size;
+            PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+            goto exit;
+        } else {
+            goto exit;
+        }
+    } else if (wasPaused) {
+        rm->lockActiveStream();
+        mStreamMutex.lock();
+        /* Control path may have moved the stream on while we were writing */
+        if (currentState == STREAM_PAUSED && !isPaused) {
+            for (int i = 0; i < mDevices.size(); i++) {
+                rm->registerDevice(mDevices[i], this);
+            }
+            currentState = STREAM_STARTED;
+        }
+        mStreamMutex.unlock();
+        rm->unlockActiveStream();
+    }
+    PAL_VERBOSE(LOG_TAG, "Exit. session write successful size - %d", size);
+    return size;
+
 exit:
     PAL_ERR(LOG_TAG, "Exit session write failed status %d", status);
     return status;
 }
 
+/* Called with mStreamMutex held before the session state or devices
+ * change. No I/O is admitted while paused, so this never waits on a write
+ * that only a resume could release.
+ */
+void StreamPCM::waitForIoDrain_l()
+{
+    uint32_t inFlight = mIoGate.inFlight();
+
+    if (inFlight > 0)
+        PAL_DBG(LOG_TAG, "waiting for %u in-flight I/O to finish", inFlight);
+    mIoGate.drain_l();
+}
+
 int32_t  StreamPCM::registerCallBack(pal_stream_callback /*cb*/, uint64_t /*cookie*/)
 {
     return 0;
@@ -1212,6 +1253,7 @@ int32_t StreamPCM::pause_l()
     if (rm->cardState == CARD_STATUS_OFFLINE) {
         cachedState = STREAM_PAUSED;
         isPaused = true;
+        mIoGate.setPaused_l(true);
         PAL_ERR(LOG_TAG, "Sound Card Offline, cached state %d", cachedState);
         goto exit;
     }
@@ -1267,6 +1309,7 @@ int32_t StreamPCM::pause_l()
         }
         ar_mem_cpy(mVolumeData, volSize, voldata, volSize);
 
+        waitForIoDrain_l();
         status = session->setConfig(this, MODULE, PAUSE_TAG);
         if (0 != status) {
            PAL_ERR(LOG_TAG, "session setConfig for pause failed with status %d",
@@ -1281,6 +1324,7 @@ int32_t StreamPCM::pause_l()
             usleep(VOLUME_RAMP_PERIOD);
         }
         isPaused = true;
+        mIoGate.setPaused_l(true);
         currentState = STREAM_PAUSED;
         PAL_DBG(LOG_TAG, "session setConfig successful");
     }
@@ -1354,6 +1398,7 @@ int32_t StreamPCM::resume_l()
     }
 
     isPaused = false;
+    mIoGate.setPaused_l(false);
 
     //since we set the volume to 0 in pause, in resume we need to set vol back to default
     if (mVolumeData) {
@@ -1410,6 +1455,7 @@ int32_t StreamPCM::flush()
         goto exit;
     }
 
+    waitForIoDrain_l();
     status = session->flush();
 exit:
     mStreamMutex.unlock();
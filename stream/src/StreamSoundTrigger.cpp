@@ -97,6 +97,7 @@ StreamSoundTrigger::StreamSoundTrigger(struct pal_stream_attributes *sattr,
     int32_t enable_concurrency_count = 0;
     int32_t disable_concurrency_count = 0;
     reader_ = nullptr;
+    lab_reads_in_flight_ = 0;
     detection_state_ = ENGINE_IDLE;
     notification_state_ = ENGINE_IDLE;
     model_id_ = 0;
@@ -275,6 +276,7 @@ StreamSoundTrigger::~StreamSoundTrigger() {
         rec_config_ = nullptr;
     }
 
+    WaitForLabReadDrain();
     if (reader_) {
         delete reader_;
         reader_ = nullptr;
@@ -378,8 +380,11 @@ int32_t StreamSoundTrigger::stop() {
 
 int32_t StreamSoundTrigger::read(struct pal_buffer* buf) {
     int32_t size = 0;
-    uint32_t sleep_ms = 0;
+    uint32_t buf_ms = 0;
     uint32_t offset = 0;
+    bool waited = false;
+    PalRingBufferReader *reader = nullptr;
+    StReadBufferEventConfigData *ev_data = nullptr;
 
     PAL_VERBOSE(LOG_TAG, "Enter");
 
@@ -388,7 +393,7 @@ int32_t StreamSoundTrigger::read(struct pal_buffer* buf) {
         return -EINVAL;
     }
 
-    std::lock_guard<std::mutex> lck(mStreamMutex);
+    std::unique_lock<std::mutex> lck(mStreamMutex);
     if (cur_state_ == st_buffering_) {
         if (!this->force_nlpi_vote) {
             rm->voteSleepMonitor(this, true, true);
@@ -412,22 +417,50 @@ int32_t StreamSoundTrigger::read(struct pal_buffer* buf) {
         lab_cnt++;
     }
 
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StReadBufferEventConfig((void *)buf));
-    size = cur_state_->ProcessEvent(ev_cfg);
+    buf_ms = (buf->size * BITS_PER_BYTE * MS_PER_SEC) /
+        (sm_cfg_->GetSampleRate() * sm_cfg_->GetBitWidth() *
+         sm_cfg_->GetOutChannels());
+
+    /*
+     * Block on the ring until the DSP has written a full buffer instead of
+     * pacing reads with a fixed sleep, so LAB data reaches the client as
+     * soon as it lands. The wait runs without mStreamMutex; stop/SSR
+     * disable or reset the reader, which ends the wait, and teardown
+     * drains in-flight reads before the reader is freed.
+     */
+    if (reader_ && reader_->isEnabled() && reader_->getUnreadSize() < buf->size) {
+        reader = reader_;
+        {
+            std::lock_guard<std::mutex> lab_lck(lab_read_mutex_);
+            lab_reads_in_flight_++;
+        }
+        lck.unlock();
+        reader->waitForBuffers(buf->size, 2 * buf_ms);
+        EndLabRead();
+        lck.lock();
+        waited = true;
+        if (cur_state_ != st_buffering_ || reader_ != reader) {
+            PAL_DBG(LOG_TAG, "LAB read cancelled, state %d", GetCurrentStateId());
+            return 0;
+        }
+    }
+
+    if (!read_buf_ev_cfg_)
+        read_buf_ev_cfg_ = std::make_shared<StReadBufferEventConfig>(nullptr);
+    ev_data = (StReadBufferEventConfigData *)read_buf_ev_cfg_->data_.get();
+    ev_data->data_ = (void *)buf;
+    size = cur_state_->ProcessEvent(read_buf_ev_cfg_);
 
     vui_intf_->ProcessLab(buf->buffer, size);
 
     /*
-     * st stream read pcm data from ringbuffer with almost no
-     * delay, sleep for some time after each read even if read
-     * fails or no enough data in ring buffer
+     * Nothing to block on when the reader is disabled (e.g. buffering
+     * stopped but state not yet moved), keep the old pacing so the
+     * client does not spin.
      */
-    if (size <= 0 || reader_->getUnreadSize() < buf->size) {
-        sleep_ms = (buf->size * BITS_PER_BYTE * MS_PER_SEC) /
-            (sm_cfg_->GetSampleRate() * sm_cfg_->GetBitWidth() *
-             sm_cfg_->GetOutChannels());
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+    if (size <= 0 && !waited) {
+        lck.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(buf_ms));
     }
 
     PAL_VERBOSE(LOG_TAG, "Exit, read size %d", size);
@@ -954,6 +987,28 @@ void StreamSoundTrigger::CancelDelayedStop() {
     timer_wait_cond_.notify_one();
 }
 
+void StreamSoundTrigger::EndLabRead() {
+    std::lock_guard<std::mutex> lck(lab_read_mutex_);
+    if (--lab_reads_in_flight_ == 0)
+        lab_read_cond_.notify_all();
+}
+
+/*
+ * Called with mStreamMutex held before reader_ is released. New reads
+ * cannot start while we hold the stream lock, so disable the reader to
+ * wake blocked ones and wait for them to leave the ring.
+ */
+void StreamSoundTrigger::WaitForLabReadDrain() {
+    std::unique_lock<std::mutex> lck(lab_read_mutex_);
+    if (lab_reads_in_flight_ == 0)
+        return;
+
+    PAL_DBG(LOG_TAG, "waiting for %u LAB read(s) to drain", lab_reads_in_flight_);
+    if (reader_)
+        reader_->updateState(READER_DISABLED);
+    lab_read_cond_.wait(lck, [&] { return lab_reads_in_flight_ == 0; });
+}
+
 std::shared_ptr<SoundTriggerEngine> StreamSoundTrigger::HandleEngineLoad(
     uint8_t *sm_data,
     int32_t sm_size,
@@ -1566,7 +1621,7 @@ int32_t StreamSoundTrigger::notifyClient(bool detection) {
             " total processing time: %llums",
             (long long)total_process_duration);
         mStreamMutex.unlock();
-        callback_((pal_stream_handle_t *)this, 0, (uint32_t *)rec_event,
+        callback_(getStreamHandle(), 0, (uint32_t *)rec_event,
                   event_size, (uint64_t)rec_config_->cookie);
 
         /*
@@ -1826,6 +1881,7 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
 
             st_stream_.mDevices.clear();
 
+            st_stream_.WaitForLabReadDrain();
             if(st_stream_.gsl_engine_)
                 st_stream_.gsl_engine_->ResetBufferReaders(st_stream_.reader_list_);
             if (st_stream_.reader_) {
@@ -2047,6 +2103,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
 
             st_stream_.mDevices.clear();
 
+            st_stream_.WaitForLabReadDrain();
             st_stream_.gsl_engine_->ResetBufferReaders(st_stream_.reader_list_);
             if (st_stream_.reader_) {
                 delete st_stream_.reader_;
@@ -2976,15 +3033,26 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
             StReadBufferEventConfigData *data =
                 (StReadBufferEventConfigData *)ev_cfg->data_.get();
             struct pal_buffer *buf = (struct pal_buffer *)data->data_;
+            struct pal_ring_buffer_view view;
 
             if (!st_stream_.reader_) {
                 PAL_ERR(LOG_TAG, "no reader exists");
                 status = -EINVAL;
                 break;
             }
-            status = st_stream_.reader_->read(buf->buffer, buf->size);
+            /* copy straight from the ring segments into the client buffer */
+            status = st_stream_.reader_->acquireView(&view, buf->size);
+            if (status <= 0)
+                break;
+
+            ar_mem_cpy(buf->buffer, buf->size, view.seg[0], view.segSize[0]);
+            if (view.segSize[1])
+                ar_mem_cpy(buf->buffer + view.segSize[0],
+                           buf->size - view.segSize[0],
+                           view.seg[1], view.segSize[1]);
+            st_stream_.reader_->commitView(status);
             if (st_stream_.vui_ptfm_info_->GetEnableDebugDumps()) {
-                ST_DBG_FILE_WRITE(st_stream_.lab_fd_, buf->buffer, buf->size);
+                ST_DBG_FILE_WRITE(st_stream_.lab_fd_, buf->buffer, status);
             }
             break;
         }
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of FrontEndPool: ids come back in the order the vector based
+ * free lists handed them out (last added first, then most recently freed
+ * first), bad frees are rejected, leaks are counted, and concurrent
+ * allocate/release never hands one id to two owners.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FrontEndPool.h"
+
+uint32_t pal_log_lvl = 0;
+
+#define NUM_THREADS 4
+#define NUM_ROUNDS 20000
+
+static void testLifoOrder()
+{
+    FrontEndPool pool("test");
+    struct fe_pool_stats stats;
+
+    assert(pool.addId(10) == 0);
+    assert(pool.addId(11) == 0);
+    assert(pool.addId(12) == 0);
+    assert(pool.addId(11) == -EINVAL);
+
+    assert(pool.allocate() == 12);
+    assert(pool.allocate() == 11);
+    assert(pool.release(12) == 0);
+    assert(pool.release(11) == 0);
+    /* the most recently freed id is reused first */
+    assert(pool.allocate() == 11);
+    assert(pool.allocate() == 12);
+    assert(pool.allocate() == 10);
+    assert(pool.allocate() == -ENOSPC);
+
+    pool.getStats(&stats);
+    assert(stats.capacity == 3);
+    assert(stats.inUse == 3);
+    assert(stats.peak == 3);
+    assert(stats.failures == 1);
+}
+
+static void testBadFrees()
+{
+    FrontEndPool pool("test");
+
+    pool.addId(1);
+    pool.addId(2);
+    assert(pool.allocate() == 2);
+    assert(pool.release(3) == -EINVAL);
+    assert(pool.release(-1) == -EINVAL);
+    assert(pool.release(1) == -EALREADY);
+    assert(pool.release(2) == 0);
+    assert(pool.release(2) == -EALREADY);
+    /* a rejected free must not put the id on the free stack twice */
+    assert(pool.allocate() == 2);
+    assert(pool.allocate() == 1);
+    assert(pool.allocate() == -ENOSPC);
+}
+
+static void testLeaks()
+{
+    FrontEndPool pool("test");
+
+    pool.addId(1);
+    pool.addId(2);
+    pool.addId(3);
+    assert(pool.checkLeaks() == 0);
+    assert(pool.allocate() == 3);
+    assert(pool.allocate() == 2);
+    assert(pool.checkLeaks() == 2);
+    pool.release(3);
+    assert(pool.checkLeaks() == 1);
+
+    pool.reset();
+    assert(pool.capacity() == 0);
+    assert(pool.allocate() == -ENOSPC);
+    assert(pool.checkLeaks() == 0);
+}
+
+/* every id is owned by at most one thread at a time */
+static void testConcurrent()
+{
+    FrontEndPool pool("test");
+    std::vector<std::atomic<int>> owners(NUM_THREADS * 2);
+    std::vector<std::thread> threads;
+    std::atomic<int> errors(0);
+    struct fe_pool_stats stats;
+
+    for (int i = 0; i < NUM_THREADS * 2; i++) {
+        pool.addId(i);
+        owners[i] = -1;
+    }
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&, t] {
+            for (int r = 0; r < NUM_ROUNDS; r++) {
+                int a = pool.allocate();
+                int b = pool.allocate();
+                int expect = -1;
+
+                if (a < 0 || b < 0) {
+                    errors++;
+                    break;
+                }
+                if (!owners[a].compare_exchange_strong(expect, t))
+                    errors++;
+                expect = -1;
+                if (!owners[b].compare_exchange_strong(expect, t))
+                    errors++;
+                owners[a] = -1;
+                owners[b] = -1;
+                if (pool.release(b) || pool.release(a))
+                    errors++;
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    assert(errors == 0);
+    assert(pool.checkLeaks() == 0);
+    pool.getStats(&stats);
+    assert(stats.inUse == 0);
+    assert(stats.failures == 0);
+    for (int i = 0; i < NUM_THREADS * 2; i++)
+        assert(pool.allocate() >= 0);
+    assert(pool.allocate() == -ENOSPC);
+}
+
+int main()
+{
+    testLifoOrder();
+    testBadFrees();
+    testLeaks();
+    testConcurrent();
+    printf("FrontEndPoolTest passed\n");
+    return 0;
+}
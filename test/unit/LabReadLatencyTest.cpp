@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of the LAB read path of StreamSoundTrigger::read() on
+ * PalRingBuffer. A simulated DSP writer thread pushes one buffer per
+ * period; the client reader either blocks in waitForBuffers() the way
+ * read() does now, or paces itself with the fixed sleep it replaced.
+ *
+ * - latency: the blocking reader must get the median buffer within half
+ *   a buffer duration of the write. The sleep paced latency depends on
+ *   the phase between reader and writer, so it is printed, not asserted.
+ * - cancellation: a reader blocked on an empty ring must return within
+ *   CANCEL_MAX_MS when the stream stops (reader disabled) or on SSR
+ *   (ring reset), long before its own timeout.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PalRingBuffer.h"
+
+uint32_t pal_log_lvl = 0;
+
+/* 16 kHz, 16 bit, mono: 10 ms per buffer */
+#define BUF_MS 10
+#define BUF_SIZE 320
+#define NUM_BUFS 100
+#define WAIT_TIMEOUT_MS 2000
+#define CANCEL_DELAY_MS 50
+#define CANCEL_MAX_MS 500
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* each buffer carries the time the DSP finished writing it */
+static void runDspWriter(PalRingBuffer *ring, int count)
+{
+    char buf[BUF_SIZE] = {0};
+    int64_t begin = nowNs();
+    int64_t writeNs = 0;
+
+    for (int i = 0; i < count; i++) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+            std::chrono::nanoseconds(begin + (int64_t)(i + 1) * BUF_MS * 1000000)));
+        writeNs = nowNs();
+        memcpy(buf, &writeNs, sizeof(writeNs));
+        assert(ring->write(buf, BUF_SIZE) == BUF_SIZE);
+    }
+}
+
+/* mirrors StreamSoundTrigger::read(): block up to two buffers, then read */
+static int readBlocking(PalRingBufferReader *reader, char *buf)
+{
+    if (reader->isEnabled() && reader->getUnreadSize() < BUF_SIZE)
+        reader->waitForBuffers(BUF_SIZE, 2 * BUF_MS);
+    return reader->read(buf, BUF_SIZE);
+}
+
+/* the read() it replaced: read, then sleep a buffer if the ring ran short */
+static int readSleepPaced(PalRingBufferReader *reader, char *buf)
+{
+    int size = reader->read(buf, BUF_SIZE);
+
+    if (size <= 0 || reader->getUnreadSize() < BUF_SIZE)
+        std::this_thread::sleep_for(std::chrono::milliseconds(BUF_MS));
+    return size;
+}
+
+static std::vector<int64_t> measure(int (*readFn)(PalRingBufferReader *, char *))
+{
+    PalRingBuffer ring(BUF_SIZE * 16);
+    PalRingBufferReader *reader = ring.newReader();
+    std::vector<int64_t> latencyNs;
+    char buf[BUF_SIZE];
+    int64_t writeNs = 0;
+    int size = 0;
+
+    reader->updateState(READER_ENABLED);
+    std::thread writer(runDspWriter, &ring, NUM_BUFS);
+
+    while ((int)latencyNs.size() < NUM_BUFS) {
+        size = readFn(reader, buf);
+        assert(size >= 0);
+        if (size == 0)
+            continue;
+        /* both readers ask for whole buffers, so reads stay aligned */
+        assert(size == BUF_SIZE);
+        memcpy(&writeNs, buf, sizeof(writeNs));
+        latencyNs.push_back(nowNs() - writeNs);
+    }
+    writer.join();
+    std::sort(latencyNs.begin(), latencyNs.end());
+    return latencyNs;
+}
+
+static void report(const char *name, std::vector<int64_t> &lat)
+{
+    printf("%-12s latency us: p50 %8.1f  p90 %8.1f  max %8.1f\n", name,
+           lat[lat.size() / 2] / 1e3, lat[lat.size() * 9 / 10] / 1e3,
+           lat.back() / 1e3);
+}
+
+static void testLatency()
+{
+    std::vector<int64_t> paced = measure(readSleepPaced);
+    std::vector<int64_t> blocking = measure(readBlocking);
+
+    report("sleep paced", paced);
+    report("blocking", blocking);
+    assert(blocking[blocking.size() / 2] < (int64_t)BUF_MS * 1000000 / 2);
+}
+
+/* a reader blocked on an empty ring is released by cancel() */
+template <typename F>
+static void testCancel(const char *name, F cancel)
+{
+    PalRingBuffer ring(BUF_SIZE * 16);
+    PalRingBufferReader *reader = ring.newReader();
+    std::atomic<bool> ready(false);
+    bool gotData = true;
+    int64_t elapsedMs = 0;
+
+    reader->updateState(READER_ENABLED);
+    std::thread client([&] {
+        int64_t begin = nowNs();
+
+        ready = true;
+        gotData = reader->waitForBuffers(BUF_SIZE, WAIT_TIMEOUT_MS);
+        elapsedMs = (nowNs() - begin) / 1000000;
+    });
+    while (!ready)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(CANCEL_DELAY_MS));
+    cancel(&ring, reader);
+    client.join();
+
+    printf("%-12s cancelled after %lld ms (timeout %d ms)\n", name,
+           (long long)elapsedMs, WAIT_TIMEOUT_MS);
+    assert(!gotData);
+    assert(elapsedMs < CANCEL_MAX_MS);
+    assert(!reader->isEnabled());
+    assert(reader->read(nullptr, BUF_SIZE) == -EINVAL);
+}
+
+int main()
+{
+    testLatency();
+    testCancel("stop", [](PalRingBuffer *, PalRingBufferReader *reader) {
+        reader->updateState(READER_DISABLED);
+    });
+    testCancel("ssr", [](PalRingBuffer *ring, PalRingBufferReader *) {
+        ring->reset();
+    });
+    printf("LabReadLatencyTest passed\n");
+    return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * The mutex based PalRingBuffer as it was before the lock-free rewrite,
+ * kept only as the baseline for PalRingBufferBenchmark. Logging is
+ * dropped and ar_mem_cpy() is plain memcpy(); the data path is unchanged.
+ */
+
+#ifndef LEGACY_PAL_RING_BUFFER_H
+#define LEGACY_PAL_RING_BUFFER_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <string.h>
+#include "PalRingBuffer.h"
+
+namespace legacy {
+
+class PalRingBuffer;
+
+class PalRingBufferReader {
+ public:
+    PalRingBufferReader(PalRingBuffer *buffer)
+        : ringBuffer_(buffer),
+          unreadSize_(0),
+          readOffset_(0),
+          state_(READER_DISABLED),
+          requestedSize_(0) {}
+
+    int32_t read(void* readBuffer, size_t readSize);
+    void updateState(pal_ring_buffer_reader_state state);
+    bool waitForBuffers(uint32_t buffer_size);
+
+    friend class PalRingBuffer;
+
+ protected:
+    PalRingBuffer *ringBuffer_;
+    size_t unreadSize_;
+    size_t readOffset_;
+    pal_ring_buffer_reader_state state_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    uint32_t requestedSize_;
+};
+
+class PalRingBuffer {
+ public:
+    explicit PalRingBuffer(size_t bufferSize)
+        : buffer_(new char[bufferSize]),
+          writeOffset_(0),
+          bufferEnd_(bufferSize) {}
+
+    ~PalRingBuffer() {
+        delete[] buffer_;
+        for (size_t i = 0; i < readOffsets_.size(); i++)
+            delete readOffsets_[i];
+    }
+
+    PalRingBufferReader* newReader() {
+        PalRingBufferReader *reader = new PalRingBufferReader(this);
+
+        readOffsets_.push_back(reader);
+        return reader;
+    }
+    size_t write(void* writeBuffer, size_t writeSize);
+
+ protected:
+    std::mutex mutex_;
+    char* buffer_;
+    size_t writeOffset_;
+    size_t bufferEnd_;
+    std::vector<PalRingBufferReader*> readOffsets_;
+    size_t getFreeSize();
+    void updateUnReadSize(size_t writtenSize);
+    friend class PalRingBufferReader;
+};
+
+inline size_t PalRingBuffer::getFreeSize()
+{
+    size_t freeSize = bufferEnd_;
+
+    for (auto it = readOffsets_.begin(); it != readOffsets_.end(); it++) {
+        if ((*(it))->state_ == READER_ENABLED)
+            freeSize = std::min(freeSize, bufferEnd_ - (*(it))->unreadSize_);
+    }
+    return freeSize;
+}
+
+inline void PalRingBuffer::updateUnReadSize(size_t writtenSize)
+{
+    for (auto it = readOffsets_.begin(); it != readOffsets_.end(); it++) {
+        (*(it))->unreadSize_ += writtenSize;
+        if ((*(it))->requestedSize_ > 0 &&
+            (*(it))->unreadSize_ >= (*(it))->requestedSize_)
+            (*(it))->cv_.notify_one();
+    }
+}
+
+inline size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t freeSize = getFreeSize();
+    size_t writtenSize = 0;
+    size_t sizeToCopy = std::min(writeSize, freeSize);
+    size_t i = 0;
+
+    if (sizeToCopy) {
+        if (writeOffset_ + sizeToCopy > bufferEnd_) {
+            i = bufferEnd_ - writeOffset_;
+            memcpy(buffer_ + writeOffset_, writeBuffer, i);
+            writtenSize += i;
+            sizeToCopy -= writtenSize;
+            memcpy(buffer_, (char*)writeBuffer + writtenSize, sizeToCopy);
+            writtenSize += sizeToCopy;
+            writeOffset_ = sizeToCopy;
+        } else {
+            memcpy(buffer_ + writeOffset_, writeBuffer, sizeToCopy);
+            writeOffset_ += sizeToCopy;
+            writtenSize = sizeToCopy;
+        }
+    }
+    updateUnReadSize(writtenSize);
+    writeOffset_ = writeOffset_ % bufferEnd_;
+    return writtenSize;
+}
+
+inline bool PalRingBufferReader::waitForBuffers(uint32_t buffer_size)
+{
+    std::unique_lock<std::mutex> lck(mutex_);
+
+    if (state_ == READER_ENABLED && unreadSize_ < buffer_size) {
+        requestedSize_ = buffer_size;
+        cv_.wait_for(lck, std::chrono::milliseconds(3000));
+    }
+    requestedSize_ = 0;
+    return unreadSize_ >= buffer_size;
+}
+
+inline int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
+{
+    size_t readSize = 0;
+
+    if (state_ == READER_DISABLED)
+        return -EINVAL;
+    if (unreadSize_ == 0)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    if (ringBuffer_->writeOffset_ > readOffset_) {
+        unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
+        readSize = std::min(bufferSize, unreadSize_);
+        memcpy(readBuffer, ringBuffer_->buffer_ + readOffset_, readSize);
+        readOffset_ += readSize;
+        unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
+    } else {
+        size_t freeClientSize = bufferSize;
+        size_t i = ringBuffer_->bufferEnd_ - readOffset_;
+
+        if (bufferSize >= i) {
+            memcpy(readBuffer, ringBuffer_->buffer_ + readOffset_, i);
+            readSize = i;
+            freeClientSize -= readSize;
+            unreadSize_ = ringBuffer_->writeOffset_;
+            readOffset_ = 0;
+            i = std::min(freeClientSize, unreadSize_);
+            memcpy((char *)readBuffer + readSize, ringBuffer_->buffer_, i);
+            readSize += i;
+            readOffset_ = i;
+            unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
+        } else {
+            memcpy(readBuffer, ringBuffer_->buffer_ + readOffset_, bufferSize);
+            readSize = bufferSize;
+            readOffset_ += bufferSize;
+            unreadSize_ = ringBuffer_->bufferEnd_ - readOffset_ +
+                          ringBuffer_->writeOffset_;
+        }
+    }
+    return readSize;
+}
+
+inline void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
+{
+    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+
+    state_ = state;
+}
+
+} // namespace legacy
+
+#endif // LEGACY_PAL_RING_BUFFER_H
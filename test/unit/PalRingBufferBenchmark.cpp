@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * One writer and three readers on PalRingBuffer against the mutex based
+ * ring it replaced (LegacyPalRingBuffer.h). Each reader loops on
+ * waitForBuffers() and read() the way the second-stage engines do.
+ *
+ * - bulk: the writer pushes chunks as fast as the slowest reader allows,
+ *   reported as throughput.
+ * - paced: the writer pushes one chunk per period, like the DSP LAB
+ *   writer, reported as write-to-read latency.
+ *
+ * Every chunk carries its sequence number, so both runs also check that
+ * each reader sees every chunk in order. Timings are printed, not asserted.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PalRingBuffer.h"
+#include "LegacyPalRingBuffer.h"
+
+uint32_t pal_log_lvl = 0;
+
+#define NUM_READERS 3
+#define CHUNK_SIZE 640
+#define BULK_CHUNKS 50000
+#define PACED_CHUNKS 2000
+#define PACED_PERIOD_US 250
+
+struct chunk_header {
+    uint64_t seq;
+    int64_t writeNs;
+};
+
+struct result {
+    double seconds;
+    std::vector<int64_t> latencyNs;
+    int errors;
+};
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Reader>
+static void runReader(Reader *reader, int chunks, struct result *res)
+{
+    char buf[CHUNK_SIZE];
+    struct chunk_header hdr;
+    uint64_t expect = 0;
+
+    while (expect < (uint64_t)chunks) {
+        if (!reader->waitForBuffers(CHUNK_SIZE))
+            continue;
+        if (reader->read(buf, CHUNK_SIZE) != CHUNK_SIZE) {
+            res->errors++;
+            continue;
+        }
+        memcpy(&hdr, buf, sizeof(hdr));
+        res->latencyNs.push_back(nowNs() - hdr.writeNs);
+        if (hdr.seq != expect)
+            res->errors++;
+        expect = hdr.seq + 1;
+    }
+}
+
+template <typename Ring, typename Reader>
+static void run(int chunks, int periodUs, struct result *res)
+{
+    Ring ring(DEFAULT_PAL_RING_BUFFER_SIZE);
+    Reader *readers[NUM_READERS];
+    std::vector<std::thread> threads;
+    std::vector<struct result> readerRes(NUM_READERS);
+    char buf[CHUNK_SIZE] = {0};
+    struct chunk_header hdr;
+    int64_t begin = 0;
+
+    for (int i = 0; i < NUM_READERS; i++) {
+        readers[i] = ring.newReader();
+        readers[i]->updateState(READER_ENABLED);
+        readerRes[i].errors = 0;
+    }
+    for (int i = 0; i < NUM_READERS; i++)
+        threads.emplace_back(runReader<Reader>, readers[i], chunks,
+                             &readerRes[i]);
+
+    begin = nowNs();
+    for (int i = 0; i < chunks; i++) {
+        if (periodUs)
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+                std::chrono::nanoseconds(begin + (int64_t)i * periodUs * 1000)));
+        hdr.seq = i;
+        hdr.writeNs = nowNs();
+        memcpy(buf, &hdr, sizeof(hdr));
+        while (ring.write(buf, CHUNK_SIZE) == 0)
+            std::this_thread::yield();
+    }
+    for (auto &t : threads)
+        t.join();
+
+    res->seconds = (nowNs() - begin) / 1e9;
+    res->errors = 0;
+    res->latencyNs.clear();
+    for (auto &r : readerRes) {
+        res->errors += r.errors;
+        res->latencyNs.insert(res->latencyNs.end(), r.latencyNs.begin(),
+                              r.latencyNs.end());
+    }
+    std::sort(res->latencyNs.begin(), res->latencyNs.end());
+}
+
+static void report(const char *name, struct result *res, int chunks)
+{
+    std::vector<int64_t> &lat = res->latencyNs;
+    double mb = (double)chunks * CHUNK_SIZE * NUM_READERS / (1024 * 1024);
+
+    printf("%-14s %8.1f MB/s  latency us: p50 %7.1f  p99 %8.1f  max %9.1f  "
+           "errors %d\n", name, mb / res->seconds,
+           lat[lat.size() / 2] / 1e3, lat[lat.size() * 99 / 100] / 1e3,
+           lat.back() / 1e3, res->errors);
+}
+
+int main()
+{
+    struct result res;
+
+    printf("%d readers, %d byte chunks\n", NUM_READERS, CHUNK_SIZE);
+
+    run<legacy::PalRingBuffer, legacy::PalRingBufferReader>(BULK_CHUNKS, 0, &res);
+    report("bulk legacy", &res, BULK_CHUNKS);
+    run<PalRingBuffer, PalRingBufferReader>(BULK_CHUNKS, 0, &res);
+    report("bulk", &res, BULK_CHUNKS);
+    assert(res.errors == 0);
+
+    run<legacy::PalRingBuffer, legacy::PalRingBufferReader>(PACED_CHUNKS,
+        PACED_PERIOD_US, &res);
+    report("paced legacy", &res, PACED_CHUNKS);
+    run<PalRingBuffer, PalRingBufferReader>(PACED_CHUNKS, PACED_PERIOD_US, &res);
+    report("paced", &res, PACED_CHUNKS);
+    assert(res.errors == 0);
+
+    printf("PalRingBufferBenchmark done\n");
+    return 0;
+}
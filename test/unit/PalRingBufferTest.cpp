@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of PalRingBuffer reader views: segment layout, the writer
+ * keeping clear of an outstanding view, and disable/reset waiting for the
+ * view to be committed.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "PalRingBuffer.h"
+
+uint32_t pal_log_lvl = 0;
+
+#define RING_SIZE 64
+
+static void fill(char *buf, size_t size, char first)
+{
+    for (size_t i = 0; i < size; i++)
+        buf[i] = first + i;
+}
+
+static void checkView(struct pal_ring_buffer_view *view, char first)
+{
+    char expect = first;
+
+    for (int s = 0; s < 2; s++) {
+        for (size_t i = 0; i < view->segSize[s]; i++)
+            assert(view->seg[s][i] == expect++);
+    }
+    assert(view->segSize[0] + view->segSize[1] == view->size);
+}
+
+static void testSegments()
+{
+    PalRingBuffer ring(RING_SIZE);
+    PalRingBufferReader *reader = ring.newReader();
+    struct pal_ring_buffer_view view;
+    char data[RING_SIZE];
+
+    assert(reader->acquireView(&view, 16) == -EINVAL);
+    reader->updateState(READER_ENABLED);
+    assert(reader->acquireView(&view, 16) == 0);
+
+    fill(data, 48, 0);
+    assert(ring.write(data, 48) == 48);
+    assert(reader->acquireView(&view, 16) == 16);
+    assert(view.segSize[1] == 0);
+    checkView(&view, 0);
+    assert(reader->acquireView(&view, 16) == -EBUSY);
+    assert(reader->read(data, 16) == -EBUSY);
+    assert(reader->commitView(16) == 16);
+    assert(reader->commitView(16) == 0);
+
+    /* partial commit leaves the rest unread */
+    assert(reader->acquireView(&view, 32) == 32);
+    checkView(&view, 16);
+    assert(reader->commitView(8) == 8);
+    assert(reader->getUnreadSize() == 24);
+    assert(reader->acquireView(&view, 32) == 24);
+    assert(reader->commitView(24) == 24);
+
+    /* 48 + 32 bytes wrap the 64 byte storage */
+    fill(data, 32, 48);
+    assert(ring.write(data, 32) == 32);
+    assert(reader->acquireView(&view, 32) == 32);
+    assert(view.segSize[0] == 16 && view.segSize[1] == 16);
+    checkView(&view, 48);
+    assert(reader->commitView(32) == 32);
+    assert(reader->getUnreadSize() == 0);
+}
+
+/* the writer never overwrites data under an outstanding view */
+static void testWriterKeepsClear()
+{
+    PalRingBuffer ring(RING_SIZE);
+    PalRingBufferReader *reader = ring.newReader();
+    PalRingBufferReader *other = ring.newReader();
+    struct pal_ring_buffer_view view;
+    char data[RING_SIZE];
+
+    reader->updateState(READER_ENABLED);
+    other->updateState(READER_ENABLED);
+    fill(data, RING_SIZE, 0);
+    assert(ring.write(data, 32) == 32);
+    assert(reader->acquireView(&view, 32) == 32);
+    assert(other->advanceReadOffset(32) == 32);
+    assert(ring.write(data, RING_SIZE) == 32);
+    checkView(&view, 0);
+    assert(reader->commitView(32) == 32);
+    assert(ring.write(data, RING_SIZE) == 32);
+    assert(ring.write(data, RING_SIZE) == 0);
+}
+
+static void waitBlocked(std::atomic<bool> &done)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!done);
+}
+
+static void testDisableWaitsForView()
+{
+    PalRingBuffer ring(RING_SIZE);
+    PalRingBufferReader *reader = ring.newReader();
+    struct pal_ring_buffer_view view;
+    std::atomic<bool> done(false);
+    char data[16] = {0};
+
+    reader->updateState(READER_ENABLED);
+    ring.write(data, sizeof(data));
+    assert(reader->acquireView(&view, 16) == 16);
+    std::thread t([&] {
+        reader->updateState(READER_DISABLED);
+        done = true;
+    });
+    waitBlocked(done);
+    assert(reader->commitView(16) == 16);
+    t.join();
+    assert(!reader->isEnabled());
+}
+
+static void testResetWaitsForView()
+{
+    PalRingBuffer ring(RING_SIZE);
+    PalRingBufferReader *reader = ring.newReader();
+    struct pal_ring_buffer_view view;
+    std::atomic<bool> done(false);
+    char data[16] = {0};
+
+    reader->updateState(READER_ENABLED);
+    ring.write(data, sizeof(data));
+    assert(reader->acquireView(&view, 16) == 16);
+    std::thread t([&] {
+        ring.reset();
+        done = true;
+    });
+    waitBlocked(done);
+    assert(reader->commitView(16) == 16);
+    t.join();
+    assert(reader->getUnreadSize() == 0);
+    assert(!reader->isEnabled());
+}
+
+int main()
+{
+    testSegments();
+    testWriterKeepsClear();
+    testDisableWaitsForView();
+    testResetWaitsForView();
+    printf("PalRingBufferTest passed\n");
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of the speaker calibration window: a fake clock drives the
+ * usage transitions and the idle deadline the calibration thread sleeps
+ * until.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "SpkrCalWindow.h"
+
+#define MIN_IDLE_SEC 30
+
+class FakeClock : public SpkrCalClock {
+public:
+    int64_t now = 1000;
+    int64_t nowSec() override { return now; }
+};
+
+/* while the speaker plays, only a stop transition can open the window */
+static void testInUse()
+{
+    FakeClock clock;
+    SpkrCalWindow window(&clock);
+
+    window.setInUse(true);
+    clock.now += 3600;
+    assert(window.idleSec() == 0);
+    assert(window.remaining(MIN_IDLE_SEC, false) == SPKR_CAL_WAIT_STOP);
+    assert(window.remaining(MIN_IDLE_SEC, true) == SPKR_CAL_WAIT_STOP);
+}
+
+/* the deadline counts from the last stop, not from the last check */
+static void testDeadline()
+{
+    FakeClock clock;
+    SpkrCalWindow window(&clock);
+
+    window.setInUse(true);
+    clock.now += 5;
+    window.setInUse(false);
+    assert(window.lastUsedSec() == clock.now);
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC);
+    clock.now += 12;
+    assert(window.idleSec() == 12);
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC - 12);
+    clock.now += MIN_IDLE_SEC - 12;
+    assert(window.remaining(MIN_IDLE_SEC, false) == 0);
+    clock.now += 100;
+    assert(window.remaining(MIN_IDLE_SEC, false) == 0);
+}
+
+/* a start/stop before the deadline re-arms it for a full idle time */
+static void testRearm()
+{
+    FakeClock clock;
+    SpkrCalWindow window(&clock);
+
+    window.setInUse(false);
+    clock.now += MIN_IDLE_SEC - 1;
+    window.setInUse(true);
+    clock.now += 2;
+    window.setInUse(false);
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC);
+    clock.now += MIN_IDLE_SEC;
+    assert(window.remaining(MIN_IDLE_SEC, false) == 0);
+    /* failed calibration: retry only after another idle time */
+    window.restartIdle();
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC);
+}
+
+/* dynamic calibration skips the idle time but not the usage check */
+static void testDynamicCal()
+{
+    FakeClock clock;
+    SpkrCalWindow window(&clock);
+
+    window.setInUse(false);
+    assert(window.remaining(MIN_IDLE_SEC, true) == 0);
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC);
+}
+
+/* a clock stepping back never yields negative idle time or an early window */
+static void testClockBackwards()
+{
+    FakeClock clock;
+    SpkrCalWindow window(&clock);
+
+    window.setInUse(false);
+    clock.now -= 10;
+    assert(window.idleSec() == 0);
+    assert(window.remaining(MIN_IDLE_SEC, false) == MIN_IDLE_SEC);
+}
+
+int main()
+{
+    testInUse();
+    testDeadline();
+    testRearm();
+    testDynamicCal();
+    testClockBackwards();
+    printf("SpkrCalWindowTest passed\n");
+    return 0;
+}
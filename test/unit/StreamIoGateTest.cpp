@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of the stream I/O gate: a fake stream follows StreamPCM's
+ * locking around a fake session whose write blocks while paused, the
+ * way a pcm write on a paused playback session does. Pause followed by
+ * stop or by a device switch must complete while a writer keeps writing.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "StreamIoGate.h"
+
+#define PERIOD_MS 2
+#define TIMEOUT_MS 2000
+
+class FakeSession {
+public:
+    /* runs one period, or blocks until resumed or stopped */
+    int write()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (paused_) {
+            blockedWrites++;
+            cv_.wait(lock, [this] { return !paused_ || stopped_; });
+        }
+        if (stopped_)
+            return -EIO;
+        busy_ = true;
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD_MS));
+        lock.lock();
+        busy_ = false;
+        writes++;
+        return 0;
+    }
+
+    /* control calls; none of them may overlap a write */
+    void pause() { set(true, false); }
+    void resume() { set(false, false); }
+    void stop() { set(false, true); }
+    void setDevice() { set(paused_, stopped_); }
+
+    std::atomic<int> writes{0};
+    std::atomic<int> blockedWrites{0};
+    std::atomic<int> overlaps{0};
+
+private:
+    void set(bool paused, bool stopped)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (busy_)
+            overlaps++;
+        paused_ = paused;
+        stopped_ = stopped;
+        cv_.notify_all();
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool paused_ = false;
+    bool stopped_ = false;
+    bool busy_ = false;
+};
+
+/* mirrors StreamPCM: write() in STARTED or PAUSED, control under the lock */
+class FakeStream {
+public:
+    enum { STOPPED, STARTED, PAUSED };
+
+    int write()
+    {
+        int status;
+
+        mStreamMutex.lock();
+        if (state != STARTED && state != PAUSED) {
+            mStreamMutex.unlock();
+            return -EIO;
+        }
+        status = gate.enter_l();
+        mStreamMutex.unlock();
+        if (status)
+            return status;
+        status = session.write();
+        gate.exit();
+        return status;
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        session.resume();
+        state = STARTED;
+    }
+
+    void pause()
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        gate.drain_l();
+        session.pause();
+        gate.setPaused_l(true);
+        state = PAUSED;
+    }
+
+    void resume()
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        session.resume();
+        gate.setPaused_l(false);
+        state = STARTED;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        gate.drain_l();
+        gate.setPaused_l(false);
+        session.stop();
+        state = STOPPED;
+    }
+
+    void switchDevice()
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        gate.drain_l();
+        session.setDevice();
+    }
+
+    FakeSession session;
+    StreamIoGate gate;
+
+private:
+    std::mutex mStreamMutex;
+    int state = STOPPED;
+};
+
+/* a deadlock shows up as a hang, fail it instead */
+template <typename F>
+static void runWithTimeout(const char *name, F fn)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::thread t([&] {
+        fn();
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (!cv.wait_for(lock, std::chrono::milliseconds(TIMEOUT_MS),
+                     [&] { return done; })) {
+        fprintf(stderr, "%s: timed out, control path deadlocked\n", name);
+        fflush(stderr);
+        _exit(1);
+    }
+    lock.unlock();
+    t.join();
+}
+
+class Writer {
+public:
+    explicit Writer(FakeStream *s) : stream(s)
+    {
+        thread = std::thread([this] {
+            while (!exit) {
+                int status = stream->write();
+
+                if (status == -EAGAIN)
+                    refused++;
+                /* the HAL retries a refused write after a short sleep */
+                if (status)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    ~Writer()
+    {
+        exit = true;
+        thread.join();
+    }
+
+    std::atomic<int> refused{0};
+
+private:
+    FakeStream *stream;
+    std::atomic<bool> exit{false};
+    std::thread thread;
+};
+
+static void waitForWrites(FakeStream *stream, int count)
+{
+    int target = stream->session.writes + count;
+
+    while (stream->session.writes < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+static void testPauseStop()
+{
+    FakeStream stream;
+
+    runWithTimeout("pause+stop", [&] {
+        stream.start();
+        Writer writer(&stream);
+
+        waitForWrites(&stream, 5);
+        stream.pause();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        assert(writer.refused > 0);
+        stream.stop();
+    });
+    assert(stream.session.blockedWrites == 0);
+    assert(stream.session.overlaps == 0);
+    assert(stream.gate.inFlight() == 0);
+}
+
+static void testPauseSwitchDevice()
+{
+    FakeStream stream;
+
+    runWithTimeout("pause+device switch", [&] {
+        stream.start();
+        Writer writer(&stream);
+
+        waitForWrites(&stream, 5);
+        stream.pause();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        stream.switchDevice();
+        stream.resume();
+        waitForWrites(&stream, 5);
+        stream.stop();
+    });
+    assert(stream.session.blockedWrites == 0);
+    assert(stream.session.overlaps == 0);
+}
+
+/* a stop while paused must not leave the gate shut for the next start */
+static void testRestartAfterPausedStop()
+{
+    FakeStream stream;
+
+    runWithTimeout("restart", [&] {
+        stream.start();
+        stream.pause();
+        stream.stop();
+        stream.start();
+        assert(stream.write() == 0);
+        stream.stop();
+    });
+}
+
+/* device switches during playback wait for the current period only */
+static void testSwitchWhileRunning()
+{
+    FakeStream stream;
+
+    runWithTimeout("switch while running", [&] {
+        stream.start();
+        Writer writer(&stream);
+
+        for (int i = 0; i < 20; i++) {
+            waitForWrites(&stream, 1);
+            stream.switchDevice();
+        }
+        stream.stop();
+    });
+    assert(stream.session.overlaps == 0);
+}
+
+int main()
+{
+    testPauseStop();
+    testPauseSwitchDevice();
+    testRestartAfterPausedStop();
+    testSwitchWhileRunning();
+    printf("StreamIoGateTest passed\n");
+    return 0;
+}
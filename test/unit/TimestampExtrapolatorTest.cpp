@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host test of the session timestamp model against a simulated DSP clock:
+ * the DSP session clock runs slightly off the absolute clock and every
+ * SPR read sees a random host round trip. Extrapolated timestamps must
+ * stay close to what the DSP would have reported at the same moment.
+ */
+
+#include <algorithm>
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "TimestampExtrapolator.h"
+
+#define MAX_AGE_US 20000
+#define MAX_DRIFT 0.005
+/* the read is pinned to the middle of a round trip of at most 1 ms */
+#define MAX_ERROR_US 600
+
+struct SimDsp {
+    double rate;            /* session clock rate vs absolute clock */
+    double sessionAtZero;
+    uint64_t absOffsetUs;   /* DSP absolute clock vs host clock */
+
+    uint64_t session(uint64_t hostUs) const { return (uint64_t)(sessionAtZero + rate * hostUs); }
+    uint64_t absolute(uint64_t hostUs) const { return hostUs + absOffsetUs; }
+};
+
+static uint64_t absDiff(uint64_t a, uint64_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+/* one SPR round trip: the DSP samples somewhere inside [start, end] */
+static uint64_t readDsp(TimestampExtrapolator &model, const SimDsp &dsp, uint64_t *hostUs)
+{
+    uint64_t start = *hostUs;
+    uint64_t latency = 100 + rand() % 900;
+    uint64_t sampled = start + rand() % (latency + 1);
+
+    *hostUs = start + latency;
+    return model.update(dsp.session(sampled), dsp.absolute(sampled),
+                        start + latency / 2);
+}
+
+static void testAccuracy(double rate)
+{
+    TimestampExtrapolator model(MAX_AGE_US, MAX_DRIFT);
+    SimDsp dsp = {rate, 1000000, 5000000};
+    uint64_t host = 0, session = 0, absolute = 0, prev = 0, maxErr = 0;
+    int served = 0, reads = 0;
+
+    /* client polls every 2 ms for 10 s */
+    for (int i = 0; i < 5000; i++) {
+        host += 2000;
+        if (model.extrapolate(host, &session, &absolute) == 0) {
+            served++;
+            maxErr = std::max(maxErr, absDiff(session, dsp.session(host)));
+            assert(absDiff(absolute, dsp.absolute(host)) <= MAX_ERROR_US);
+        } else {
+            reads++;
+            session = readDsp(model, dsp, &host);
+        }
+        assert(session >= prev);
+        prev = session;
+    }
+    printf("rate %.4f: %d served, %d reads, max error %llu us\n", rate, served,
+           reads, (unsigned long long)maxErr);
+    assert(maxErr <= MAX_ERROR_US);
+    assert(served > reads);
+    assert(model.rate() > rate - 0.001 && model.rate() < rate + 0.001);
+}
+
+/* a stalled clock must not be extrapolated and must not report fake pairs */
+static void testStall()
+{
+    TimestampExtrapolator model(MAX_AGE_US, MAX_DRIFT);
+    uint64_t session = 0, absolute = 0;
+
+    model.update(0, 0, 0);
+    model.update(25000, 25000, 25000);
+    model.update(50000, 50000, 50000);
+    assert(model.rate() > 0.99);
+    /* underrun: session time stops while absolute time moves on */
+    model.update(50000, 75000, 75000);
+    assert(model.rate() == 0);
+    assert(model.extrapolate(76000, &session, &absolute) == -EAGAIN);
+}
+
+/* no rate yet: every query goes to the DSP */
+static void testNoRateNoCache()
+{
+    TimestampExtrapolator model(MAX_AGE_US, MAX_DRIFT);
+    uint64_t session = 0, absolute = 0;
+
+    assert(model.extrapolate(0, &session, &absolute) == -EAGAIN);
+    model.update(1000, 1000, 1000);
+    assert(model.extrapolate(2000, &session, &absolute) == -EAGAIN);
+    /* short DSP windows do not produce a rate */
+    model.update(6000, 6000, 6000);
+    assert(model.extrapolate(7000, &session, &absolute) == -EAGAIN);
+    model.update(21000, 21000, 21000);
+    assert(model.extrapolate(22000, &session, &absolute) == 0);
+    assert(session == 22000 && absolute == 22000);
+    /* readings older than the max age are not extrapolated */
+    assert(model.extrapolate(21000 + MAX_AGE_US, &session, &absolute) == -EAGAIN);
+    model.reset();
+    assert(model.extrapolate(22000, &session, &absolute) == -EAGAIN);
+}
+
+int main()
+{
+    srand(1);
+    testAccuracy(1.0);
+    testAccuracy(1.002);
+    testAccuracy(0.997);
+    testStall();
+    testNoRateNoCache();
+    printf("TimestampExtrapolatorTest passed\n");
+    return 0;
+}
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Replays every stream, streampp, device and devicepp selector combination
+ * of a usecaseKvManager.xml through UsecaseKvIndex::find() and through the
+ * linear findKVs() it replaced, checks that both return the same KVs and
+ * reports the time per lookup of each.
+ *
+ * Per id type and keys_and_values entry the queries are:
+ * - the entry's own selector pairs (exact match),
+ * - one value per selector, as getSelectorValues() fills them at runtime,
+ * - the entry's pairs with one pair dropped (superset fallback),
+ * and, per id type, the empty selector set and an unknown selector value.
+ *
+ * Usage: UsecaseKvIndexBenchmark [usecaseKvManager.xml ...]
+ */
+
+#include <assert.h>
+#include <expat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "UsecaseKvIndex.h"
+
+#define DEFAULT_CONFIG "configs/kalama/usecaseKvManager.xml"
+#define BENCH_ROUNDS 20
+#define MAX_EXPANSIONS 64
+
+typedef std::vector<std::pair<selector_type_t, std::string>> selectors;
+typedef std::vector<std::pair<int, int>> kvs;
+
+enum { STREAMS, STREAMPPS, DEVICES, DEVICEPPS, NUM_LISTS };
+static const char *listNames[NUM_LISTS] = { "stream", "streampp", "device", "devicepp" };
+static const char *listTags[NUM_LISTS] = { "streams", "streampps", "devices", "devicepps" };
+
+struct kv_config {
+    std::vector<allKVs> lists[NUM_LISTS];
+    /* type and device names stand for their PAL ids, only equality matters */
+    std::map<std::string, int> ids;
+    int parsing = -1;
+};
+
+/* findKVs() and compareSelectorPairs() before the index, logging dropped */
+namespace legacy {
+
+static bool compareSelectorPairs(selectors &selector_pairs, selectors &filled_selector_pairs)
+{
+    size_t count = 0;
+
+    if (selector_pairs.size() == filled_selector_pairs.size()) {
+        std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
+        std::sort(selector_pairs.begin(), selector_pairs.end());
+        return std::equal(selector_pairs.begin(), selector_pairs.end(),
+            filled_selector_pairs.begin());
+    }
+    for (size_t i = 0; i < filled_selector_pairs.size(); i++) {
+        if (selector_pairs.end() != std::find(selector_pairs.begin(),
+            selector_pairs.end(), filled_selector_pairs[i]))
+            count++;
+    }
+    return filled_selector_pairs.size() == count;
+}
+
+static bool isIdTypeAvailable(int32_t type, std::vector<int> &id_type)
+{
+    return std::find(id_type.begin(), id_type.end(), type) != id_type.end();
+}
+
+static bool findKVs(selectors &filled_selector_pairs, uint32_t type,
+    std::vector<allKVs> &any_type, kvs &keyVector)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < any_type.size(); i++) {
+        if (!isIdTypeAvailable(type, any_type[i].id_type))
+            continue;
+        for (size_t j = 0; j < any_type[i].keys_values.size(); j++) {
+            struct kvInfo &info = any_type[i].keys_values[j];
+
+            if (filled_selector_pairs.empty() != true) {
+                if (!compareSelectorPairs(info.selector_pairs, filled_selector_pairs))
+                    continue;
+            } else if (!info.selector_pairs.empty()) {
+                continue;
+            }
+            for (auto &kv : info.kv_pairs)
+                keyVector.push_back(std::make_pair(kv.key, kv.value));
+            found = true;
+            break;
+        }
+    }
+    return found;
+}
+
+} // namespace legacy
+
+static bool indexedFindKVs(selectors &filled_selector_pairs, uint32_t type,
+    std::vector<allKVs> &any_type, const kvTypeIndex &index, kvs &keyVector)
+{
+    std::vector<const struct kvInfo *> matches;
+
+    if (!UsecaseKvIndex::find(filled_selector_pairs, type, any_type, index, matches))
+        return false;
+    for (auto match : matches) {
+        for (auto &kv : match->kv_pairs)
+            keyVector.push_back(std::make_pair(kv.key, kv.value));
+    }
+    return true;
+}
+
+static std::vector<std::string> splitStrings(const std::string &str)
+{
+    std::vector<std::string> tokens;
+    std::stringstream check(str);
+    std::string token;
+
+    while (getline(check, token, ',')) {
+        token.erase(0, token.find_first_not_of(' '));
+        token.erase(token.find_last_not_of(' ') + 1);
+        if (!token.empty())
+            tokens.push_back(token);
+    }
+    return tokens;
+}
+
+/* mirrors PayloadBuilder::startTag() and its process*Data() helpers */
+static void startTag(void *userdata, const XML_Char *tag, const XML_Char **attr)
+{
+    struct kv_config *cfg = (struct kv_config *)userdata;
+    std::vector<allKVs> *list = cfg->parsing >= 0 ? &cfg->lists[cfg->parsing] : nullptr;
+
+    for (int i = 0; i < NUM_LISTS; i++) {
+        if (!strcmp(tag, listTags[i])) {
+            cfg->parsing = i;
+            return;
+        }
+        if (!strcmp(tag, listNames[i]) && list) {
+            allKVs block;
+
+            for (auto &name : splitStrings(attr[1])) {
+                if (cfg->ids.find(name) == cfg->ids.end())
+                    cfg->ids.emplace(name, (int)cfg->ids.size());
+                block.id_type.push_back(cfg->ids[name]);
+            }
+            list->push_back(block);
+            return;
+        }
+    }
+    if (!strcmp(tag, "keys_and_values") && list && !list->empty()) {
+        struct kvInfo info;
+
+        for (int i = 0; attr[i]; i += 2) {
+            info.selector_names.push_back(attr[i]);
+            for (auto &value : splitStrings(attr[i + 1]))
+                info.selector_pairs.push_back(std::make_pair(
+                    selectorstypeLUT.at(attr[i]), value));
+        }
+        list->back().keys_values.push_back(info);
+    } else if (!strcmp(tag, "graph_kv") && list && !list->empty() &&
+               !list->back().keys_values.empty()) {
+        struct kvPairs kv;
+
+        kv.key = strtoul(attr[1], nullptr, 16);
+        kv.value = strtoul(attr[3], nullptr, 16);
+        list->back().keys_values.back().kv_pairs.push_back(kv);
+    }
+}
+
+static bool compareNumSelectors(struct kvInfo info_1, struct kvInfo info_2)
+{
+    return (info_1.selector_names.size() < info_2.selector_names.size());
+}
+
+/* mirrors PayloadBuilder::endTag(): entries ordered by selector count */
+static void endTag(void *userdata, const XML_Char *tag)
+{
+    struct kv_config *cfg = (struct kv_config *)userdata;
+
+    for (int i = 0; i < NUM_LISTS; i++) {
+        if (!strcmp(tag, listTags[i])) {
+            cfg->parsing = -1;
+        } else if (!strcmp(tag, listNames[i]) && !cfg->lists[i].empty()) {
+            std::sort(cfg->lists[i].back().keys_values.begin(),
+                cfg->lists[i].back().keys_values.end(), compareNumSelectors);
+        }
+    }
+}
+
+static bool parseConfig(const char *path, struct kv_config *cfg)
+{
+    FILE *file = fopen(path, "r");
+    XML_Parser parser = nullptr;
+    char buf[4096];
+    size_t len = 0;
+    bool ok = true;
+
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    parser = XML_ParserCreate(NULL);
+    XML_SetUserData(parser, cfg);
+    XML_SetElementHandler(parser, startTag, endTag);
+    do {
+        len = fread(buf, 1, sizeof(buf), file);
+        if (XML_Parse(parser, buf, len, len == 0) == XML_STATUS_ERROR) {
+            fprintf(stderr, "%s: %s at line %lu\n", path,
+                XML_ErrorString(XML_GetErrorCode(parser)),
+                (unsigned long)XML_GetCurrentLineNumber(parser));
+            ok = false;
+            break;
+        }
+    } while (len);
+    XML_ParserFree(parser);
+    fclose(file);
+    return ok;
+}
+
+struct query {
+    int list;
+    int32_t type;
+    selectors pairs;
+};
+
+/* one value per selector type, the way filled selectors look at runtime */
+static void addExpansions(std::vector<struct query> &queries, int list,
+    int32_t type, const selectors &pairs)
+{
+    std::map<selector_type_t, std::vector<std::string>> byType;
+    std::vector<selectors> expanded(1);
+
+    for (auto &pair : pairs)
+        byType[pair.first].push_back(pair.second);
+    for (auto &sel : byType) {
+        std::vector<selectors> next;
+
+        for (auto &partial : expanded) {
+            for (auto &value : sel.second) {
+                if (next.size() >= MAX_EXPANSIONS)
+                    break;
+                next.push_back(partial);
+                next.back().push_back(std::make_pair(sel.first, value));
+            }
+        }
+        expanded.swap(next);
+    }
+    for (auto &sel : expanded)
+        queries.push_back({list, type, sel});
+}
+
+static std::vector<struct query> buildQueries(struct kv_config *cfg)
+{
+    std::vector<struct query> queries;
+
+    for (int l = 0; l < NUM_LISTS; l++) {
+        for (auto &block : cfg->lists[l]) {
+            for (int32_t type : block.id_type) {
+                queries.push_back({l, type, {}});
+                queries.push_back({l, type, {{DIRECTION_SEL, "#unknown"}}});
+                for (auto &info : block.keys_values) {
+                    queries.push_back({l, type, info.selector_pairs});
+                    addExpansions(queries, l, type, info.selector_pairs);
+                    for (size_t k = 0; k < info.selector_pairs.size(); k++) {
+                        selectors dropped = info.selector_pairs;
+
+                        dropped.erase(dropped.begin() + k);
+                        queries.push_back({l, type, dropped});
+                    }
+                }
+            }
+        }
+    }
+    /* runtime order of selectors is not sorted */
+    for (auto &q : queries)
+        std::reverse(q.pairs.begin(), q.pairs.end());
+    return queries;
+}
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int runConfig(const char *path)
+{
+    struct kv_config cfg;
+    std::vector<allKVs> legacyLists[NUM_LISTS];
+    kvTypeIndex index[NUM_LISTS];
+    std::vector<struct query> queries;
+    int mismatches = 0;
+    size_t hits = 0;
+    int64_t legacyNs = 0, indexedNs = 0, begin = 0;
+
+    if (!parseConfig(path, &cfg))
+        return -1;
+
+    for (int l = 0; l < NUM_LISTS; l++) {
+        legacyLists[l] = cfg.lists[l];
+        UsecaseKvIndex::build(cfg.lists[l], index[l]);
+    }
+    queries = buildQueries(&cfg);
+
+    for (auto &q : queries) {
+        selectors a = q.pairs, b = q.pairs;
+        kvs legacyKvs, indexedKvs;
+        bool legacyFound = legacy::findKVs(a, q.type, legacyLists[q.list], legacyKvs);
+        bool indexedFound = indexedFindKVs(b, q.type, cfg.lists[q.list],
+            index[q.list], indexedKvs);
+
+        if (legacyFound != indexedFound || legacyKvs != indexedKvs) {
+            fprintf(stderr, "%s: %s type %d with %zu selectors: legacy %zu KVs, "
+                "indexed %zu KVs\n", path, listNames[q.list], q.type,
+                q.pairs.size(), legacyKvs.size(), indexedKvs.size());
+            mismatches++;
+        }
+        hits += legacyFound;
+    }
+
+    /* both lookups sort the filled selectors, so each round gets fresh
+     * unsorted copies made outside the timed loop */
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        std::vector<struct query> work = queries;
+
+        begin = nowNs();
+        for (auto &q : work) {
+            kvs keyVector;
+
+            legacy::findKVs(q.pairs, q.type, legacyLists[q.list], keyVector);
+        }
+        legacyNs += nowNs() - begin;
+
+        work = queries;
+        begin = nowNs();
+        for (auto &q : work) {
+            kvs keyVector;
+
+            indexedFindKVs(q.pairs, q.type, cfg.lists[q.list], index[q.list], keyVector);
+        }
+        indexedNs += nowNs() - begin;
+    }
+
+    printf("%s: %zu lookups (%zu hits), linear %.0f ns, indexed %.0f ns per "
+           "lookup, mismatches %d\n", path, queries.size(), hits,
+           (double)legacyNs / BENCH_ROUNDS / queries.size(),
+           (double)indexedNs / BENCH_ROUNDS / queries.size(), mismatches);
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    int failed = 0;
+
+    if (argc < 2) {
+        failed = runConfig(DEFAULT_CONFIG) != 0;
+    } else {
+        for (int i = 1; i < argc; i++)
+            failed += runConfig(argv[i]) != 0;
+    }
+    assert(failed == 0);
+    printf("UsecaseKvIndexBenchmark passed\n");
+    return 0;
+}
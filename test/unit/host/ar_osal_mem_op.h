@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Host stand-in for the AR OSAL memory ops, so PAL utilities that only
+ * need ar_mem_cpy() can be built into host unit tests. PalCommon.h pulls
+ * this in, so it also covers the bionic __unused the sources rely on.
+ */
+
+#ifndef AR_OSAL_MEM_OP_H
+#define AR_OSAL_MEM_OP_H
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef __unused
+#define __unused __attribute__((unused))
+#endif
+
+static inline size_t ar_mem_cpy(void *dst, size_t dst_size, const void *src,
+                                size_t src_size)
+{
+    size_t size = src_size < dst_size ? src_size : dst_size;
+
+    memcpy(dst, src, size);
+    return size;
+}
+
+#endif // AR_OSAL_MEM_OP_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef PAL_EXECUTOR_H
+#define PAL_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PAL_EXECUTOR_MAX_THREADS 4
+
+class PalStrand;
+
+/*
+ * Small process-wide worker pool. Threads are spawned on demand up to
+ * PAL_EXECUTOR_MAX_THREADS and then reused, so subsystems that only need
+ * to hand work off do not each own a thread. Tasks must not block for
+ * unbounded time (e.g. wait on a DSP buffer loop); such work keeps its
+ * dedicated thread.
+ */
+class PalExecutor {
+public:
+    static std::shared_ptr<PalExecutor> getInstance();
+    ~PalExecutor();
+    void post(std::function<void()> task);
+    std::shared_ptr<PalStrand> createStrand(const char *name);
+
+private:
+    PalExecutor(size_t maxThreads);
+    void workerLoop();
+
+    static std::shared_ptr<PalExecutor> instance;
+    static std::mutex instanceMutex;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    size_t maxThreads_;
+    size_t idleThreads_;
+    bool exit_;
+};
+
+/*
+ * Serial queue on top of the shared pool: tasks posted to one strand run
+ * one at a time and in order, on whichever pool thread is free.
+ */
+class PalStrand : public std::enable_shared_from_this<PalStrand> {
+public:
+    PalStrand(std::shared_ptr<PalExecutor> executor, const char *name);
+    ~PalStrand() {};
+    int32_t post(std::function<void()> task);
+    void shutdown();
+
+private:
+    void run();
+
+    std::shared_ptr<PalExecutor> executor_;
+    std::string name_;
+    std::mutex mutex_;
+    std::condition_variable idleCv_;
+    std::deque<std::function<void()>> tasks_;
+    std::thread::id runner_;
+    bool scheduled_;
+    bool closed_;
+};
+
+#endif // PAL_EXECUTOR_H
@@ -34,6 +34,8 @@
 
 
 #include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -53,53 +55,87 @@ typedef enum {
 
 class PalRingBuffer;
 
+/*
+ * Unread ring data in place. The data wraps at most once, so it spans up
+ * to two segments; segSize[1] is 0 unless it wrapped.
+ */
+struct pal_ring_buffer_view {
+    const char *seg[2];
+    size_t segSize[2];
+    size_t size;
+};
+
+/*
+ * Single writer / multiple reader ring. Writer and readers track monotonic
+ * byte positions; the data path only exchanges those positions through
+ * atomics, so readers never take the ring mutex. The ring mutex only
+ * serializes the writer against control operations (reader add/remove,
+ * enable, reset, resize).
+ *
+ * A reader can instead take a view of its unread data with acquireView()
+ * and consume it in place; commitView() advances past the consumed bytes
+ * and releases the view. While a view is held the writer does not
+ * overwrite it, and disable, reset and resize wait for it to be
+ * committed, so the holder must commit before it disables or resets its
+ * own reader.
+ */
 class PalRingBufferReader {
  public:
      PalRingBufferReader(PalRingBuffer *buffer)
          : ringBuffer_(buffer),
-           unreadSize_(0),
-           readOffset_(0),
+           readPos_(0),
+           state_(READER_DISABLED),
            requestedSize_(0),
-           state_(READER_DISABLED) {}
+           viewHeld_(false),
+           viewSize_(0) {}
 
     ~PalRingBufferReader() {};
 
     size_t advanceReadOffset(size_t advanceSize);
     int32_t read(void* readBuffer, size_t readSize);
+    int32_t acquireView(struct pal_ring_buffer_view *view, size_t maxSize);
+    size_t commitView(size_t consumed);
     void updateState(pal_ring_buffer_reader_state state);
     void getIndices(uint32_t *startIndice, uint32_t *endIndice);
     size_t getUnreadSize();
     void reset();
     bool isEnabled() { return state_ == READER_ENABLED; }
-    bool waitForBuffers(uint32_t buffer_size);
+    bool waitForBuffers(uint32_t buffer_size, uint32_t timeout_ms = 3000);
 
     friend class PalRingBuffer;
     friend class StreamSoundTrigger;
 
  protected:
     PalRingBuffer *ringBuffer_;
-    size_t unreadSize_;
-    size_t readOffset_;
-    pal_ring_buffer_reader_state state_;
+    /* total bytes consumed by this reader, only moved by the reader */
+    std::atomic<uint64_t> readPos_;
+    std::atomic<pal_ring_buffer_reader_state> state_;
     std::mutex mutex_;
     std::condition_variable cv_;
-    uint32_t requestedSize_;
+    std::atomic<uint32_t> requestedSize_;
+    /* outstanding view, changed with the ring mutex held */
+    std::atomic<bool> viewHeld_;
+    size_t viewSize_;
+    void reset_l();
 };
 
 class PalRingBuffer {
  public:
     explicit PalRingBuffer(size_t bufferSize)
-        : buffer_((char*)(new char[bufferSize])),
+        : buffer_(nullptr),
           startIndex(0),
           endIndex(0),
-          writeOffset_(0),
-          bufferEnd_(bufferSize) {}
+          writePos_(0),
+          bufferEnd_(0),
+          mask_(0) {
+        allocBuffer(bufferSize);
+    }
 
     ~PalRingBuffer() {
         if (buffer_)
-            delete buffer_;
+            delete[] buffer_;
 
-        for (int i = 0; i < readOffsets_.size(); i++)
+        for (size_t i = 0; i < readOffsets_.size(); i++)
             delete readOffsets_[i];
     }
 
@@ -117,13 +153,22 @@ class PalRingBuffer {
 
  protected:
     std::mutex mutex_;
+    /* signalled with mutex_ held when a reader commits its view */
+    std::condition_variable viewCv_;
     char* buffer_;
-    uint32_t startIndex;
-    uint32_t endIndex;
-    size_t writeOffset_;
+    std::atomic<uint32_t> startIndex;
+    std::atomic<uint32_t> endIndex;
+    /* total bytes written, published with release after the copy */
+    std::atomic<uint64_t> writePos_;
+    /* usable capacity; storage is rounded up to a power of two */
     size_t bufferEnd_;
+    size_t mask_;
     std::vector<PalRingBufferReader*> readOffsets_;
-    void updateUnReadSize(size_t writtenSize);
+    void allocBuffer(size_t bufferSize);
+    size_t unreadSize(PalRingBufferReader *reader);
+    void copyOut(void *dst, uint64_t pos, size_t size);
+    void notifyReaders();
+    void waitForViews_l(std::unique_lock<std::mutex> &lock);
     friend class PalRingBufferReader;
 };
 #endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#define LOG_TAG "PAL: PalExecutor"
+
+#include <errno.h>
+#include "PalExecutor.h"
+#include "PalCommon.h"
+
+std::shared_ptr<PalExecutor> PalExecutor::instance = nullptr;
+std::mutex PalExecutor::instanceMutex;
+
+std::shared_ptr<PalExecutor> PalExecutor::getInstance()
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance)
+        instance = std::shared_ptr<PalExecutor>(
+            new PalExecutor(PAL_EXECUTOR_MAX_THREADS));
+    return instance;
+}
+
+PalExecutor::PalExecutor(size_t maxThreads)
+    : maxThreads_(maxThreads),
+      idleThreads_(0),
+      exit_(false)
+{
+}
+
+PalExecutor::~PalExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void PalExecutor::post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    tasks_.push_back(std::move(task));
+    if (idleThreads_ == 0 && workers_.size() < maxThreads_) {
+        workers_.emplace_back(&PalExecutor::workerLoop, this);
+        PAL_DBG(LOG_TAG, "spawned worker %zu", workers_.size());
+        return;
+    }
+    cv_.notify_one();
+}
+
+void PalExecutor::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (1) {
+        if (tasks_.empty() && !exit_) {
+            idleThreads_++;
+            cv_.wait(lock, [&] { return !tasks_.empty() || exit_; });
+            idleThreads_--;
+        }
+        if (exit_)
+            break;
+
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+std::shared_ptr<PalStrand> PalExecutor::createStrand(const char *name)
+{
+    return std::make_shared<PalStrand>(getInstance(), name);
+}
+
+PalStrand::PalStrand(std::shared_ptr<PalExecutor> executor, const char *name)
+    : executor_(executor),
+      name_(name ? name : ""),
+      scheduled_(false),
+      closed_(false)
+{
+}
+
+int32_t PalStrand::post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+        PAL_ERR(LOG_TAG, "strand %s is shut down", name_.c_str());
+        return -EPIPE;
+    }
+    tasks_.push_back(std::move(task));
+    if (!scheduled_) {
+        scheduled_ = true;
+        std::shared_ptr<PalStrand> self = shared_from_this();
+        executor_->post([self] { self->run(); });
+    }
+    return 0;
+}
+
+/* Drains the queue on a pool thread; only one run() is scheduled at a time */
+void PalStrand::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    runner_ = std::this_thread::get_id();
+    while (!tasks_.empty() && !closed_) {
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+    runner_ = std::thread::id();
+    scheduled_ = false;
+    idleCv_.notify_all();
+}
+
+/*
+ * Drop pending tasks, reject new ones and wait for the running task to
+ * return. Safe to call from a task of this strand, which then skips the
+ * wait since it is the running task.
+ */
+void PalStrand::shutdown()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    closed_ = true;
+    tasks_.clear();
+    if (runner_ == std::this_thread::get_id())
+        return;
+    idleCv_.wait(lock, [&] { return !scheduled_; });
+    PAL_DBG(LOG_TAG, "strand %s shut down", name_.c_str());
+}
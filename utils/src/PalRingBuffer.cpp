@@ -40,8 +40,42 @@
 #include "PalCommon.h"
 #define LOG_TAG "PAL: PalRingBuffer"
 
+void PalRingBuffer::allocBuffer(size_t bufferSize)
+{
+    size_t storage = 1;
+
+    /* power-of-two storage lets positions map to offsets with a mask */
+    while (storage < bufferSize)
+        storage <<= 1;
+    buffer_ = (char *)new char[storage];
+    mask_ = storage - 1;
+    bufferEnd_ = bufferSize;
+}
+
+size_t PalRingBuffer::unreadSize(PalRingBufferReader *reader)
+{
+    uint64_t readPos = reader->readPos_.load(std::memory_order_acquire);
+    uint64_t writePos = writePos_.load(std::memory_order_acquire);
+
+    /* transiently possible while the ring is being reset */
+    if (readPos > writePos)
+        return 0;
+    return (size_t)(writePos - readPos);
+}
+
+void PalRingBuffer::copyOut(void *dst, uint64_t pos, size_t size)
+{
+    size_t offset = pos & mask_;
+    size_t first = std::min(size, mask_ + 1 - offset);
+
+    ar_mem_cpy(dst, first, buffer_ + offset, first);
+    if (size > first)
+        ar_mem_cpy((char *)dst + first, size - first, buffer_, size - first);
+}
+
 int32_t PalRingBuffer::removeReader(PalRingBufferReader *reader)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto iter = std::find(readOffsets_.begin(), readOffsets_.end(), reader);
     if (iter != readOffsets_.end())
         readOffsets_.erase(iter);
@@ -55,236 +89,245 @@ size_t PalRingBuffer::read(std::shared_ptr<PalRingBufferReader>reader __unused,
     return 0;
 }
 
+/* Called with mutex_ held */
 size_t PalRingBuffer::getFreeSize()
 {
-
-    size_t freeSize = bufferEnd_;
+    size_t usedSize = 0;
     std::vector<PalRingBufferReader*>::iterator it;
 
+    /* data under an outstanding view is in use until it is committed */
     for (it = readOffsets_.begin(); it != readOffsets_.end(); it++) {
-        if ((*(it))->state_ == READER_ENABLED)
-            freeSize = std::min(freeSize, bufferEnd_ - (*(it))->unreadSize_);
+        if ((*(it))->state_ == READER_ENABLED || (*(it))->viewHeld_)
+            usedSize = std::max(usedSize, std::min(unreadSize(*it), bufferEnd_));
     }
-    return freeSize;
+    return bufferEnd_ - usedSize;
 }
 
-void PalRingBuffer::updateUnReadSize(size_t writtenSize)
+/* Called with mutex_ held, after writePos_ has been published */
+void PalRingBuffer::notifyReaders()
 {
     int32_t i = 0;
     std::vector<PalRingBufferReader*>::iterator it;
 
     for (it = readOffsets_.begin(); it != readOffsets_.end(); it++, i++) {
-        (*(it))->unreadSize_ += writtenSize;
-        PAL_VERBOSE(LOG_TAG, "Reader (%d), unreadSize(%zu)", i, (*(it))->unreadSize_);
-
-        if ((*(it))->requestedSize_ > 0 &&
-            (*(it))->unreadSize_ >= (*(it))->requestedSize_) {
-             (*(it))->cv_.notify_one();
+        uint32_t requested = (*(it))->requestedSize_.load();
+
+        PAL_VERBOSE(LOG_TAG, "Reader (%d), unreadSize(%zu)", i, unreadSize(*it));
+        if (requested > 0 && unreadSize(*it) >= requested) {
+            /* take the reader lock so the wakeup cannot slip in between
+             * its predicate check and the wait */
+            std::lock_guard<std::mutex> lock((*(it))->mutex_);
+            (*(it))->cv_.notify_one();
         }
     }
 }
 
+/* Called with mutex_ held via lock, returns once no reader holds a view */
+void PalRingBuffer::waitForViews_l(std::unique_lock<std::mutex> &lock)
+{
+    viewCv_.wait(lock, [this] {
+        return std::none_of(readOffsets_.begin(), readOffsets_.end(),
+                [](PalRingBufferReader *reader) { return reader->viewHeld_.load(); });
+    });
+}
+
 void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
 {
     startIndex = startIndice;
     endIndex = endIndice;
-    PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndex, endIndex);
+    PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndice, endIndice);
 }
 
 size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
 {
-    /* update the unread size for each reader*/
-    mutex_.lock();
+    std::lock_guard<std::mutex> lock(mutex_);
     size_t freeSize = getFreeSize();
-    size_t writtenSize = 0;
-    int32_t i = 0;
-    size_t sizeToCopy = 0;
-
-    PAL_DBG(LOG_TAG, "Enter. freeSize(%zu), writeOffset(%zu)", freeSize, writeOffset_);
+    uint64_t writePos = writePos_.load(std::memory_order_relaxed);
+    size_t sizeToCopy = std::min(writeSize, freeSize);
+    size_t offset = writePos & mask_;
+    size_t first = 0;
 
-    if (writeSize <= freeSize)
-        sizeToCopy = writeSize;
-    else
-        sizeToCopy = freeSize;
+    PAL_DBG(LOG_TAG, "Enter. freeSize(%zu), writeOffset(%zu)", freeSize, offset);
 
     if (sizeToCopy) {
         //buffer wrapped around
-        if (writeOffset_ + sizeToCopy > bufferEnd_) {
-            i = bufferEnd_ - writeOffset_;
-
-            ar_mem_cpy(buffer_ + writeOffset_, i, writeBuffer, i);
-            writtenSize += i;
-            sizeToCopy -= writtenSize;
-            ar_mem_cpy(buffer_, sizeToCopy, (char*)writeBuffer + writtenSize,
-                             sizeToCopy);
-            writtenSize += sizeToCopy;
-            writeOffset_ = sizeToCopy;
-        } else {
-            ar_mem_cpy(buffer_ + writeOffset_, sizeToCopy, writeBuffer,
-                             sizeToCopy);
-            writeOffset_ += sizeToCopy;
-            writtenSize = sizeToCopy;
-        }
+        first = std::min(sizeToCopy, mask_ + 1 - offset);
+        ar_mem_cpy(buffer_ + offset, first, writeBuffer, first);
+        if (sizeToCopy > first)
+            ar_mem_cpy(buffer_, sizeToCopy - first, (char *)writeBuffer + first,
+                       sizeToCopy - first);
+        writePos_.store(writePos + sizeToCopy);
+        notifyReaders();
     }
-    updateUnReadSize(writtenSize);
-    writeOffset_ = writeOffset_ % bufferEnd_;
-    PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", writeOffset_);
-    mutex_.unlock();
-    return writtenSize;
+    PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", (size_t)((writePos + sizeToCopy) & mask_));
+    return sizeToCopy;
 }
 
 void PalRingBuffer::reset()
 {
     std::vector<PalRingBufferReader*>::iterator it;
+    std::unique_lock<std::mutex> lock(mutex_);
 
-    mutex_.lock();
+    waitForViews_l(lock);
     startIndex = 0;
     endIndex = 0;
-    writeOffset_ = 0;
-    mutex_.unlock();
+    writePos_ = 0;
 
-    /* Reset all the associated readers */
+    /* Reset all the associated readers, under mutex_ so that neither
+     * the reader list nor a write can change in between */
     for (it = readOffsets_.begin(); it != readOffsets_.end(); it++)
-        (*(it))->reset();
+        (*(it))->reset_l();
 }
 
 void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
 {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    waitForViews_l(lock);
     if (buffer_) {
         delete[] buffer_;
         buffer_ = nullptr;
     }
-    buffer_ = (char *)new char[bufferSize];
-    bufferEnd_ = bufferSize;
+    allocBuffer(bufferSize);
 }
 
-bool PalRingBufferReader::waitForBuffers(uint32_t buffer_size)
+/*
+ * Block until buffer_size bytes are unread, the reader is disabled or reset,
+ * or timeout_ms elapses. Returns whether the requested data is available.
+ */
+bool PalRingBufferReader::waitForBuffers(uint32_t buffer_size, uint32_t timeout_ms)
 {
     std::unique_lock<std::mutex> lck(mutex_);
-    if (state_ == READER_ENABLED) {
-        if (unreadSize_ >= buffer_size)
-            goto exit;
+    if (state_ == READER_ENABLED && getUnreadSize() < buffer_size) {
         requestedSize_ = buffer_size;
-        cv_.wait_for(lck, std::chrono::milliseconds(3000));
+        cv_.wait_for(lck, std::chrono::milliseconds(timeout_ms), [&] {
+            return state_ != READER_ENABLED || getUnreadSize() >= buffer_size;
+        });
+        requestedSize_ = 0;
     }
 
-exit:
-    requestedSize_ = 0;
-    return unreadSize_ >= buffer_size;
+    return getUnreadSize() >= buffer_size;
 }
 
 int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
 {
-    int32_t readSize = 0;
+    size_t readSize = 0;
+    uint64_t readPos = 0;
 
     if (state_ == READER_DISABLED)
         return -EINVAL;
 
+    if (viewHeld_) {
+        PAL_ERR(LOG_TAG, "Cannot read while a view is held");
+        return -EBUSY;
+    }
+
     // Return 0 when no data can be read for current reader
-    if (unreadSize_ == 0)
+    readSize = std::min(bufferSize, ringBuffer_->unreadSize(this));
+    if (readSize == 0)
         return 0;
 
-    ringBuffer_->mutex_.lock();
-
-    // when writeOffset leads readOffset
-    if (ringBuffer_->writeOffset_ > readOffset_) {
-        unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-
-        if (bufferSize >= unreadSize_) {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, unreadSize_);
-            readOffset_ += unreadSize_;
-            readSize = unreadSize_;
-            unreadSize_ = 0;
-        } else {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readOffset_ += bufferSize;
-            readSize = bufferSize;
-            unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-        }
-    } else {
-        //When readOffset leads WriteOffset
-        int32_t freeClientSize = bufferSize;
-        int32_t i = ringBuffer_->bufferEnd_ - readOffset_;
-
-        if (bufferSize >= i) {
-            ar_mem_cpy(readBuffer, i, (char*)(ringBuffer_->buffer_ +
-                             readOffset_), i);
-            readSize = i;
-            freeClientSize -= readSize;
-            unreadSize_ = ringBuffer_->writeOffset_;
-            readOffset_ = 0;
-            //copy remaining unread buffer
-            if (freeClientSize > unreadSize_) {
-                ar_mem_cpy((char *)readBuffer + readSize, unreadSize_,
-                                 ringBuffer_->buffer_, unreadSize_);
-                readSize += unreadSize_;
-                readOffset_ = unreadSize_;
-                unreadSize_ = 0;
-            } else {
-                //copy whatever we can
-                ar_mem_cpy((char *)readBuffer + readSize, freeClientSize,
-                                 ringBuffer_->buffer_, freeClientSize);
-                readSize += freeClientSize;
-                readOffset_ = freeClientSize;
-                unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-            }
-
-        } else {
-            ar_mem_cpy(readBuffer, bufferSize, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readSize = bufferSize;
-            readOffset_ += bufferSize;
-            unreadSize_ = ringBuffer_->bufferEnd_ - readOffset_ +
-                          ringBuffer_->writeOffset_;
-        }
-    }
-    ringBuffer_->mutex_.unlock();
+    readPos = readPos_.load(std::memory_order_relaxed);
+    ringBuffer_->copyOut(readBuffer, readPos, readSize);
+    readPos_.store(readPos + readSize, std::memory_order_release);
     return readSize;
 }
 
-size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
+/*
+ * Expose up to maxSize unread bytes in place without consuming them.
+ * Returns the view size, 0 when there is no unread data, or an error.
+ */
+int32_t PalRingBufferReader::acquireView(struct pal_ring_buffer_view *view,
+                                         size_t maxSize)
 {
-    size_t size_advanced = 0;
+    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    size_t size = 0;
+    size_t offset = 0;
 
+    memset(view, 0, sizeof(*view));
+    if (state_ == READER_DISABLED)
+        return -EINVAL;
+
+    if (viewHeld_) {
+        PAL_ERR(LOG_TAG, "View already held");
+        return -EBUSY;
+    }
+
+    size = std::min(maxSize, ringBuffer_->unreadSize(this));
+    if (size == 0)
+        return 0;
+
+    offset = readPos_.load(std::memory_order_relaxed) & ringBuffer_->mask_;
+    view->seg[0] = ringBuffer_->buffer_ + offset;
+    view->segSize[0] = std::min(size, ringBuffer_->mask_ + 1 - offset);
+    if (size > view->segSize[0]) {
+        view->seg[1] = ringBuffer_->buffer_;
+        view->segSize[1] = size - view->segSize[0];
+    }
+    view->size = size;
+    viewSize_ = size;
+    viewHeld_ = true;
+    return size;
+}
+
+/* Consume the first consumed bytes of the held view and release it */
+size_t PalRingBufferReader::commitView(size_t consumed)
+{
     std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
 
-    /* add code to advance the offset here*/
-    if (unreadSize_ < advanceSize) {
-        PAL_ERR(LOG_TAG, "Cannot advance read offset %zu greater than unread size %zu",
-            advanceSize, unreadSize_);
-        return size_advanced;
+    if (!viewHeld_)
+        return 0;
+
+    consumed = std::min(consumed, viewSize_);
+    readPos_.fetch_add(consumed, std::memory_order_release);
+    viewSize_ = 0;
+    viewHeld_ = false;
+    ringBuffer_->viewCv_.notify_all();
+    return consumed;
+}
+
+size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
+{
+    size_t unreadSize = ringBuffer_->unreadSize(this);
+
+    if (viewHeld_) {
+        PAL_ERR(LOG_TAG, "Cannot advance read offset while a view is held");
+        return 0;
     }
 
-    unreadSize_ -= advanceSize;
-    if (readOffset_ + advanceSize < ringBuffer_->bufferEnd_) {
-        readOffset_ += advanceSize;
-    } else {
-        readOffset_ = readOffset_ + advanceSize - ringBuffer_->bufferEnd_;
+    /* add code to advance the offset here*/
+    if (unreadSize < advanceSize) {
+        PAL_ERR(LOG_TAG, "Cannot advance read offset %zu greater than unread size %zu",
+            advanceSize, unreadSize);
+        return 0;
     }
-    size_advanced += advanceSize;
 
-    return size_advanced;
+    readPos_.fetch_add(advanceSize, std::memory_order_release);
+    return advanceSize;
 }
 
 void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
 {
+    std::unique_lock<std::mutex> lock(ringBuffer_->mutex_);
+
     PAL_DBG(LOG_TAG, "update reader state to %d", state);
-    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    if (state == READER_DISABLED)
+        ringBuffer_->viewCv_.wait(lock, [this] { return !viewHeld_; });
 
     if (state_ == READER_DISABLED && state == READER_ENABLED) {
-        if (unreadSize_ > ringBuffer_->bufferEnd_)
-           unreadSize_ = ringBuffer_->bufferEnd_;
-
-        if (unreadSize_ <= ringBuffer_->writeOffset_) {
-            readOffset_ = ringBuffer_->writeOffset_ - unreadSize_;
-        } else {
-            readOffset_ = ringBuffer_->writeOffset_ +
-                ringBuffer_->bufferEnd_ - unreadSize_;
-        }
+        size_t unreadSize = std::min(ringBuffer_->unreadSize(this),
+                                     ringBuffer_->bufferEnd_);
+
+        readPos_ = ringBuffer_->writePos_ - unreadSize;
     }
     state_ = state;
+    lock.unlock();
+
+    /* release anyone blocked in waitForBuffers() */
+    if (state == READER_DISABLED) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
 }
 
 void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
@@ -292,28 +335,38 @@ void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
     *startIndice = ringBuffer_->startIndex;
     *endIndice = ringBuffer_->endIndex;
     PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u",
-                ringBuffer_->startIndex, ringBuffer_->endIndex);
+                *startIndice, *endIndice);
 }
 
 size_t PalRingBufferReader::getUnreadSize()
 {
-    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize_);
-    return unreadSize_;
+    size_t unreadSize = ringBuffer_->unreadSize(this);
+
+    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize);
+    return unreadSize;
 }
 
 void PalRingBufferReader::reset()
 {
-    ringBuffer_->mutex_.lock();
-    readOffset_ = 0;
-    unreadSize_ = 0;
+    std::unique_lock<std::mutex> ringLock(ringBuffer_->mutex_);
+
+    ringBuffer_->viewCv_.wait(ringLock, [this] { return !viewHeld_; });
+    reset_l();
+}
+
+/* Called with the ring mutex held and no view outstanding */
+void PalRingBufferReader::reset_l()
+{
+    readPos_ = ringBuffer_->writePos_.load();
     state_ = READER_DISABLED;
-    ringBuffer_->mutex_.unlock();
     requestedSize_ = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
     cv_.notify_all();
 }
 
 PalRingBufferReader* PalRingBuffer::newReader()
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     PalRingBufferReader* readOffset =
                   new PalRingBufferReader(this);
     readOffsets_.push_back(readOffset);